@@ -52,6 +52,7 @@ STATIC elem * assignparams(elem **pe,int *psi,elem **pe2);
 STATIC void emptyloops();
 STATIC int el_anyframeptr(elem *e);
 STATIC void blassertsplit();
+STATIC void bllayout();
 
 unsigned numblks;       // number of basic blocks in current function
 block *startblock;      /* beginning block of function                  */
@@ -587,6 +588,8 @@ void blockopt(int iter)
                 count++;
             } while (mergeblks());      /* merge together blocks         */
         } while (go.changes);
+        if (iter >= 1)
+            bllayout();                 // final placement of blocks
 #ifdef DEBUG
         if (debugw)
         {
@@ -1001,7 +1004,7 @@ STATIC void brrear()
                                 list_ptr(bl) = list_ptr(bt->Bsucc);
                                 if (bt->Bsrcpos.Slinnum && !b->Bsrcpos.Slinnum)
                                     b->Bsrcpos = bt->Bsrcpos;
-                                b->Bflags |= bt->Bflags;
+                                b->Bflags |= bt->Bflags & ~BFLcold;
                                 list_append(&(list_block(bl)->Bpred),b);
                                 list_subtract(&(bt->Bpred),b);
                                 cmes("goto->goto\n");
@@ -2159,4 +2162,103 @@ STATIC void blassertsplit()
     }
 }
 
+/**********************************
+ * Decide the final order of the blocks. The hot blocks come first, each
+ * falling through to its most frequently executed successor, followed by
+ * the cold blocks so they don't take up room in the instruction cache.
+ * Cold blocks are those marked BFLcold (by __builtin_expect() or the
+ * profile), those that never return (asserts, throws), and those that
+ * only lead to or are only reached from cold blocks.
+ */
+
+STATIC void bllayout()
+{
+    cmes("bllayout()\n");
+
+    // Leave functions with exception handling or inline assembler alone
+    unsigned n = 0;
+    for (block *b = startblock; b; b = b->Bnext)
+    {
+        b->Bflags &= ~BFLmark;          // may be left set by func_anypath()
+        if (b->Btry || b->BC == BCasm || (b->BC >= BCtry && b->BC != BCjump))
+            return;
+        if (b->BC == BCexit || (b->Belem && !el_returns(b->Belem)))
+            b->Bflags |= BFLcold;
+        n++;
+    }
+
+    bool changes;
+    do
+    {
+        changes = false;
+        for (block *b = startblock->Bnext; b; b = b->Bnext)
+        {
+            if (b->Bflags & BFLcold)
+                continue;
+            bool cold = b->Bsucc != NULL;
+            for (list_t bl = b->Bsucc; bl && cold; bl = list_next(bl))
+                cold = (list_block(bl)->Bflags & BFLcold) != 0;
+            if (!cold)
+            {
+                cold = b->Bpred != NULL;
+                for (list_t bl = b->Bpred; bl && cold; bl = list_next(bl))
+                    cold = (list_block(bl)->Bflags & BFLcold) != 0;
+            }
+            if (cold)
+            {   b->Bflags |= BFLcold;
+                changes = true;
+            }
+        }
+    } while (changes);
+
+    block **blocks = (block **) mem_malloc(2 * n * sizeof(block *));
+    block **order = blocks + n;
+    unsigned i = 0;
+    for (block *b = startblock; b; b = b->Bnext)
+        blocks[i++] = b;
+
+    unsigned norder = 0;
+    unsigned next = 0;                  // first hot block in blocks[] that may not be placed
+    block *b = startblock;
+    while (1)
+    {
+        order[norder++] = b;
+        b->Bflags |= BFLmark;
+
+        block *bnext = NULL;
+        for (list_t bl = b->Bsucc; bl; bl = list_next(bl))
+        {
+            block *bs = list_block(bl);
+            if (bs->Bflags & (BFLmark | BFLcold))
+                continue;
+            if (!bnext || bs->Bweight > bnext->Bweight ||
+                (bs->Bweight == bnext->Bweight && bs == b->Bnext))
+                bnext = bs;
+        }
+        if (!bnext)
+        {
+            while (next < n && blocks[next]->Bflags & (BFLmark | BFLcold))
+                next++;
+            if (next == n)
+                break;
+            bnext = blocks[next];
+        }
+        b = bnext;
+    }
+    for (i = 0; i < n; i++)
+    {
+        if (!(blocks[i]->Bflags & BFLmark))
+            order[norder++] = blocks[i];
+    }
+    assert(norder == n);
+
+    for (i = 0; i < n; i++)
+    {
+        order[i]->Bflags &= ~BFLmark;
+        order[i]->Bnext = (i + 1 < n) ? order[i + 1] : NULL;
+    }
+    assert(startblock == order[0]);
+    mem_free(blocks);
+}
+
 #endif //!SPP
@@ -424,6 +424,7 @@ enum
     BFLunwind        = 0x1000,  // do local_unwind following block (unused)
 #endif
     BFLnomerg        = 0x20,    // do not merge with other blocks
+    BFLcold          = 0x40,    // block is unlikely to be executed
     BFLprolog        = 0x80,    // generate function prolog
     BFLepilog        = 0x100,   // generate function epilog
     BFLrefparam      = 0x200,   // referenced parameter
@@ -1324,6 +1325,7 @@ struct Symbol
 #define isscover(s)             ((s)->Sclass == SCstruct || (s)->Sclass == SCenum || (s)->Sclass == SCtemplate)
     unsigned Ssequence;         // sequence number (used for 2 level lookup)
                                 // also used as 'parameter number' for SCTtemparg
+    unsigned Spriority;         // symbol table treap priority, 0 if not computed yet
 #elif MARS
     const char *prettyIdent;    // the symbol identifier as the user sees it
 #endif
@@ -320,7 +320,7 @@ typedef long double longdouble;
 // Precompiled header variations
 #define MEMORYHX        (_WINDLL && _WIN32)     // HX and SYM files are cached in memory
 #define MMFIO           (_WIN32 || __linux__ || __APPLE__ || __FreeBSD__ || __OpenBSD__ || __DragonFly__ || __sun)  // if memory mapped files
-#define LINEARALLOC     _WIN32  // if we can reserve address ranges
+#define LINEARALLOC     MMFIO   // if we can reserve address ranges
 
 // H_STYLE takes on one of these precompiled header methods
 enum
@@ -683,6 +683,7 @@ enum
     TARGET_PentiumMMX       = 6,
     TARGET_PentiumPro       = 7,
     TARGET_PentiumII        = 8,
+    TARGET_Core             = 9,       // out-of-order cores, used for target_scheduler only
 };
 
 // Symbolic debug info
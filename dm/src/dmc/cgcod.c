@@ -350,9 +350,21 @@ tryagain:
         if (b->Bflags & BFLprolog)      // do function prolog
         {
             startoffset = coffset + calcblksize(cprolog) - funcoffset;
-            b->Bcode = cat(cprolog,b->Bcode);
+            /* The Core scheduler moves instructions across the whole block,
+             * so keep the prolog away from it; the unwind info and
+             * startoffset depend on the prolog's layout.
+             */
+            if (config.target_scheduler == TARGET_Core)
+            {   cgsched_block(b);
+                b->Bcode = cat(cprolog,b->Bcode);
+            }
+            else
+            {   b->Bcode = cat(cprolog,b->Bcode);
+                cgsched_block(b);
+            }
         }
-        cgsched_block(b);
+        else
+            cgsched_block(b);
         b->Bsize = calcblksize(b->Bcode);       // calculate block size
         if (b->Balign)
         {   targ_size_t u = b->Balign - 1;
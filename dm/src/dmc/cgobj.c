@@ -2039,6 +2039,15 @@ int Obj::jmpTableSegment(Symbol *s)
     return (config.flags & CFGromable) ? cseg : DATA;
 }
 
+/***********************************
+ * Returns:
+ *      segment for code unlikely to be executed
+ */
+int Obj::coldcodeseg()
+{
+    return cseg;                // OMF has no section naming convention for it
+}
+
 /**********************************
  * Reset code seg to existing seg.
  * Used after a COMDAT for a function is done.
@@ -22,6 +22,7 @@
 #include        "code.h"
 #include        "global.h"
 #include        "type.h"
+#include        "go.h"
 
 static char __file__[] = __FILE__;      /* for tassert.h                */
 #include        "tassert.h"
@@ -731,6 +732,154 @@ void cgreg_unregister(regm_t conflict)
     }
 }
 
+/******************************************
+ * Determine if symbol s may be assigned to register reg at all.
+ */
+
+STATIC bool cgreg_regok(Symbol *s, unsigned reg, Symbol *retsym, regm_t regparams)
+{
+    unsigned dst_integer_reg;
+    unsigned dst_float_reg;
+    cgreg_dst_regs(&dst_integer_reg, &dst_float_reg);
+
+    // Symbols used as return values should only be mapped into return value registers
+    if (s == retsym && !(reg == dst_integer_reg || reg == dst_float_reg))
+        return false;
+
+    // If BP isn't available, can't assign to it
+    if (reg == BP && !(allregs & mBP))
+        return false;
+
+#if 0 && TARGET_LINUX
+    // Need EBX for static pointer
+    if (reg == BX && !(allregs & mBX))
+        return false;
+#endif
+    /* Don't assign register parameter to another register parameter
+     */
+    if ((s->Sclass == SCfastpar || s->Sclass == SCshadowreg) &&
+        mask[reg] & regparams &&
+        reg != s->Spreg)
+        return false;
+
+    if (s->Sflags & GTbyte &&
+        !(mask[reg] & BYTEREGS))
+        return false;
+
+    return true;
+}
+
+/******************************************
+ * Linear scan register assignment, selected with -o+scan.
+ * The candidates are visited heaviest Sweight first, ties going to the
+ * one whose live range starts first (in dfo order), and each is
+ * given the first register in its priority sequence that is free over the
+ * whole of its live range and shows a benefit. Unlike the weighted search
+ * in cgreg_assign(), which maps one symbol per code generation pass, every
+ * candidate that fits without spilling is mapped in the same pass.
+ * Returns:
+ *      number of symbols mapped into registers
+ */
+
+struct Scan             // candidate for linear scan
+{
+    Symbol *sym;
+    size_t start;       // first block of live range
+};
+
+static int __cdecl scan_compare(const void *e1,const void *e2)
+{
+    const Scan *p1 = (const Scan *)e1;
+    const Scan *p2 = (const Scan *)e2;
+
+    if (p1->sym->Sweight != p2->sym->Sweight)
+        return p2->sym->Sweight - p1->sym->Sweight;    // heavier first
+    if (p1->start != p2->start)
+        return (p1->start < p2->start) ? -1 : 1;
+    return 0;
+}
+
+STATIC int cgreg_scan(Symbol *retsym, regm_t regparams)
+{
+    if (!globsym.top)
+        return 0;
+    Scan *scan = (Scan *) calloc(globsym.top,sizeof(Scan));
+    assert(scan);
+    size_t n = 0;
+    for (size_t si = 0; si < globsym.top; si++)
+    {   symbol *s = globsym.tab[si];
+
+        // The return value is left to cgreg_assign(), which tries to
+        // move it into the destination register
+        if (!(s->Sflags & GTregcand) ||
+            s->Sflags & SFLspill ||
+            s->Sfl == FLreg ||
+            s == retsym)
+            continue;
+        scan[n].sym = s;
+        scan[n].start = vec_index(0,s->Srange);
+        n++;
+    }
+    qsort(scan,n,sizeof(Scan),scan_compare);
+
+    int nmapped = 0;
+    for (size_t i = 0; i < n; i++)
+    {   symbol *s = scan[i].sym;
+
+        unsigned char *pseq;                     // sequence to try for LSW
+        unsigned char *pseqmsw = NULL;           // sequence to try for MSW, NULL if none
+        cgreg_set_priorities(s->ty(), &pseq, &pseqmsw);
+
+        for (int j = 0; pseq[j] != NOREG; j++)
+        {
+            unsigned reg = pseq[j];
+
+            if (!cgreg_regok(s,reg,retsym,regparams) ||
+                !vec_disjoint(s->Srange,regrange[reg]))
+                continue;
+
+            if (cgreg_benefit(s,reg,retsym) <= 0)
+            {
+                if (!(s->Sflags & GTregcand))   // can't ever be in a register
+                    break;
+                continue;
+            }
+
+            unsigned regmsw = NOREG;
+            if (pseqmsw)
+            {
+                for (unsigned k = 0; 1; k++)
+                {
+                    regmsw = pseqmsw[k];
+                    if (regmsw == NOREG)
+                        break;
+                    if (regmsw == reg)          // can't assign msw and lsw to same reg
+                        continue;
+                    if ((s->Sclass == SCfastpar || s->Sclass == SCshadowreg) &&
+                        mask[regmsw] & regparams &&
+                        regmsw != s->Spreg2)
+                        continue;
+                    if (vec_disjoint(s->Srange,regrange[regmsw]))
+                        break;
+                }
+                if (regmsw == NOREG)
+                    continue;                   // no free register for MSW
+            }
+
+            cgreg_map(s,regmsw,reg);
+            nmapped++;
+            break;
+        }
+    }
+    free(scan);
+
+    #ifdef DEBUG
+    if (debugr)
+        printf("linear scan mapped %d of %d candidates\n",nmapped,(int)n);
+    #endif
+    return nmapped;
+}
+
 /******************************************
  * Do register assignments.
  * Returns:
@@ -821,6 +970,15 @@ int cgreg_assign(Symbol *retsym)
             regparams |= s->Spregm();
     }
 
+    /* Try the linear scan first, and fall back to the weighted search
+     * below for the return value and for spilled candidates.
+     */
+    if (go.mfoptim & MFscan && cgreg_scan(retsym,regparams))
+    {
+        vec_free(v);
+        return TRUE;
+    }
+
     // Find symbol t, which is the most 'deserving' symbol that should be
     // placed into a register.
     Reg t;
@@ -877,30 +1035,9 @@ int cgreg_assign(Symbol *retsym)
         {
             unsigned reg = pseq[i];
 
-            // Symbols used as return values should only be mapped into return value registers
-            if (s == retsym && !(reg == dst_integer_reg || reg == dst_float_reg))
+            if (!cgreg_regok(s,reg,retsym,regparams))
                 continue;
 
-            // If BP isn't available, can't assign to it
-            if (reg == BP && !(allregs & mBP))
-                continue;
-
-#if 0 && TARGET_LINUX
-            // Need EBX for static pointer
-            if (reg == BX && !(allregs & mBX))
-                continue;
-#endif
-            /* Don't assign register parameter to another register parameter
-             */
-            if ((s->Sclass == SCfastpar || s->Sclass == SCshadowreg) &&
-                mask[reg] & regparams &&
-                reg != s->Spreg)
-                continue;
-
-            if (s->Sflags & GTbyte &&
-                !(mask[reg] & BYTEREGS))
-                    continue;
-
             int benefit = cgreg_benefit(s,reg,retsym);
 
             #ifdef DEBUG
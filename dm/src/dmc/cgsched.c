@@ -81,6 +81,7 @@ struct Cinfo
 
 code *simpleops(code *c,regm_t scratch);
 static code *schedule(code *c,regm_t scratch);
+static code *schedule_core(code *c);
 code *peephole(code *c,regm_t scratch);
 
 /*****************************************
@@ -119,7 +120,15 @@ void cgsched_block(block* b)
 
         scratch &= ~(b->Bregcon.used | b->Bregcon.params | mfuncreg);
         scratch &= ~(b->Bregcon.immed.mval | b->Bregcon.cse.mval);
-        cgsched_pentium(&b->Bcode,scratch);
+        if (config.target_scheduler == TARGET_Core)
+        {
+            if (!I64)
+                b->Bcode = peephole(b->Bcode,0);
+            if (!I16)                   // forget about 16 bit code
+                b->Bcode = schedule_core(b->Bcode);
+        }
+        else
+            cgsched_pentium(&b->Bcode,scratch);
         //printf("after schedule:\n"); WRcodlst(b->Bcode);
     }
 }
@@ -1211,7 +1220,8 @@ STATIC void getinfo(Cinfo *ci,code *c)
     unsigned a32;
     int pc;
     unsigned r,w;
-    int sz = I32 ? 4 : 2;
+    int sz = I16 ? 2 : 4;
+    unsigned bytereg = c->Irex ? 7 : 3;         // with REX, byte regs 4..7 are SPL..DIL
 
     ci->r = 0;
     ci->w = 0;
@@ -1221,11 +1231,13 @@ STATIC void getinfo(Cinfo *ci,code *c)
         op = 0x0F;
     //printf("\tgetinfo %x, op %x \n",c,op);
     pc = pentcycl[op];
-    a32 = I32;
+    a32 = !I16;
     if (c->Iflags & CFaddrsize)
         a32 ^= 1;
     if (c->Iflags & CFopsize)
         sz ^= 2 | 4;
+    if (c->Irex & REX_W)
+        sz = 8;
     irm = c->Irm;
     mod = (irm >> 6) & 3;
     reg = (irm >> 3) & 7;
@@ -1569,9 +1581,9 @@ STATIC void getinfo(Cinfo *ci,code *c)
     ci->r = r & ~(R | EA);
     ci->w = w & ~(R | EA);
     if (r & R)
-        ci->r |= mask[(r & B) ? (reg & 3) : reg];
+        ci->r |= mask[(r & B) ? (reg & bytereg) : reg];
     if (w & R)
-        ci->w |= mask[(w & B) ? (reg & 3) : reg];
+        ci->w |= mask[(w & B) ? (reg & bytereg) : reg];
 
     // OR in bits for EA addressing mode
     if ((r | w) & EA)
@@ -1627,9 +1639,9 @@ STATIC void getinfo(Cinfo *ci,code *c)
 
             case 3:
                 if (r & EA)
-                    ci->r |= mask[(r & B) ? (rm & 3) : rm];
+                    ci->r |= mask[(r & B) ? (rm & bytereg) : rm];
                 if (w & EA)
-                    ci->w |= mask[(w & B) ? (rm & 3) : rm];
+                    ci->w |= mask[(w & B) ? (rm & bytereg) : rm];
                 break;
         }
         // Adjust sibmodrm so that addressing modes can be compared simply
@@ -1673,7 +1685,7 @@ STATIC void getinfo(Cinfo *ci,code *c)
 
         ci->r |= ci->a;
         ci->reg = reg;
-        ci->sibmodrm = (sib << 8) | irm;
+        ci->sibmodrm = ((c->Irex & (REX_B | REX_X)) << 16) | (sib << 8) | irm;
     }
 Lret:
     if (ci->w & mSP)                    // if stack pointer is modified
@@ -2746,6 +2758,229 @@ static code *schedule(code *c,regm_t scratch)
 
 /**************************************************************************/
 
+/* Scheduling model for out-of-order cores (scheduler 9, as in -69).
+ * Instead of filling U/V pipe or decoder slots, instructions are list
+ * scheduled to shorten the critical path through each basic block, using
+ * the latencies and issue width below.
+ */
+
+struct CoreModel
+{
+    unsigned char width;        // instructions issued per clock
+    unsigned char alu;          // simple integer operation
+    unsigned char load;         // additional latency of a memory operand
+    unsigned char imul;         // IMUL
+    unsigned char div;          // DIV, IDIV
+    unsigned char fop;          // x87 FADD, FSUB, FCOM
+    unsigned char fmul;         // x87 FMUL
+    unsigned char fdiv;         // x87 FDIV
+};
+
+static CoreModel coremodel =
+{
+    4,      // width
+    1,      // alu
+    4,      // load
+    3,      // imul
+    26,     // div
+    3,      // fop
+    5,      // fmul
+    15,     // fdiv
+};
+
+#define CORETBLMAX      64      // max instructions in a scheduling window
+
+/********************************************
+ * Get latency of instruction according to coremodel.
+ */
+
+STATIC int core_latency(Cinfo *ci)
+{
+    code *c = ci->c;
+    unsigned op = c->Iop & 0xFF;
+    unsigned reg = (c->Irm >> 3) & 7;
+    int lat = coremodel.alu;
+
+    if ((c->Iop & 0xFF00) == 0x0F00)
+    {
+        if (op == 0xAF)                         // IMUL Gv,Ev
+            lat = coremodel.imul;
+    }
+    else if (c->Iop <= 0xFF)
+    {
+        switch (op)
+        {
+            case 0x69:
+            case 0x6B:                          // IMUL Gv,Ev,imm
+                lat = coremodel.imul;
+                break;
+
+            case 0xF6:
+            case 0xF7:
+                if (reg == 4 || reg == 5)       // MUL, IMUL
+                    lat = coremodel.imul;
+                else if (reg == 6 || reg == 7)  // DIV, IDIV
+                    lat = coremodel.div;
+                break;
+
+            case 0xD8:
+            case 0xDA:
+            case 0xDC:
+            case 0xDE:
+                if (reg == 1)                   // FMUL
+                    lat = coremodel.fmul;
+                else if (reg >= 6)              // FDIV, FDIVR
+                    lat = coremodel.fdiv;
+                else
+                    lat = coremodel.fop;
+                break;
+        }
+    }
+    if (ci->r & mMEM && op != 0x8D)             // memory operand, not LEA
+        lat += coremodel.load;
+    return lat;
+}
+
+/******************************
+ * List schedule the n instructions in ci[] and append them to *pc.
+ * Returns:
+ *      new tail
+ */
+
+STATIC code **core_assemble(Cinfo *ci, int n, code **pc)
+{
+    static unsigned char dep[CORETBLMAX][CORETBLMAX];  // 1 + latency of edge i -> j
+    int height[CORETBLMAX];     // critical path from i to the end of the window
+    int npred[CORETBLMAX];      // unscheduled predecessors
+    int ready[CORETBLMAX];      // clock at which all operands are available
+    char done[CORETBLMAX];
+
+    assert(n <= CORETBLMAX);
+    for (int j = 0; j < n; j++)
+    {
+        npred[j] = 0;
+        ready[j] = 0;
+        done[j] = 0;
+        for (int i = 0; i < j; i++)
+        {
+            dep[i][j] = 0;
+            if (conflict(&ci[i],&ci[j],0) ||
+                (i == 0 && ci[0].c->Iflags & (CFtarg | CFtarg2)))  // jump target stays first
+            {   // Only a true dependency has to wait for the result
+                dep[i][j] = 1 + ((ci[i].w & ci[j].r) ? core_latency(&ci[i]) : 0);
+                npred[j]++;
+            }
+        }
+    }
+
+    // Compute critical path lengths, working backwards
+    for (int i = n; i--;)
+    {
+        int h = core_latency(&ci[i]);
+        for (int j = i + 1; j < n; j++)
+        {
+            if (dep[i][j] && dep[i][j] - 1 + height[j] > h)
+                h = dep[i][j] - 1 + height[j];
+        }
+        height[i] = h;
+    }
+
+    int clock = 0;
+    for (int nscheduled = 0; nscheduled < n; clock++)
+    {
+        for (int issued = 0; issued < coremodel.width; issued++)
+        {
+            // Pick ready instruction with the longest path to the end,
+            // earliest one in case of a tie
+            int best = -1;
+            for (int j = 0; j < n; j++)
+            {
+                if (!done[j] && npred[j] == 0 && ready[j] <= clock &&
+                    (best < 0 || height[j] > height[best]))
+                    best = j;
+            }
+            if (best < 0)
+                break;
+
+#ifdef DEBUG
+            if (debugs) { printf("%3d %3d ",clock,height[best]); ci[best].c->print(); }
+#endif
+            done[best] = 1;
+            nscheduled++;
+            for (int j = best + 1; j < n; j++)
+            {
+                if (dep[best][j])
+                {   npred[j]--;
+                    if (clock + dep[best][j] - 1 > ready[j])
+                        ready[j] = clock + dep[best][j] - 1;
+                }
+            }
+
+            *pc = ci[best].c;
+            do
+                pc = &code_next(*pc);
+            while (*pc);
+        }
+    }
+    return pc;
+}
+
+/******************************
+ * Schedule instructions for out-of-order cores.
+ * Jump targets and instructions the scheduler does not understand
+ * stay in place and divide the block into scheduling windows.
+ */
+
+static code *schedule_core(code *c)
+{
+    code *cresult = NULL;
+    code **pctail = &cresult;
+    Cinfo ci[CORETBLMAX];
+    int n = 0;
+
+    while (c)
+    {
+        code *cn = csnip(c);
+
+        if (c->Iop == NOP ||
+            (c->Iop & ESCAPEmask) == ESCAPE ||
+            c->Iflags & (CFclassinit | CFtarg | CFtarg2) ||
+            n == CORETBLMAX)
+        {
+            pctail = core_assemble(ci,n,pctail);
+            n = 0;
+        }
+
+        if (c->Iop == NOP ||
+            (c->Iop & ESCAPEmask) == ESCAPE ||
+            c->Iflags & CFclassinit)
+        {
+            // Just append this instruction to pctail
+            *pctail = c;
+            do
+                pctail = &code_next(*pctail);
+            while (*pctail);
+        }
+        else
+        {
+            getinfo(&ci[n],c);
+
+            // getinfo() doesn't decode 3 byte opcodes
+            if (c->Iop > 0xFF && (c->Iop & 0xFF00) != 0x0F00)
+            {   ci[n].r |= N;
+                ci[n].w |= N;
+            }
+            n++;
+        }
+        c = cn;
+    }
+    pctail = core_assemble(ci,n,pctail);
+
+    return cresult;
+}
+
+/**************************************************************************/
+
 /********************************************
  * Replace any occurrence of r1 in EA with r2.
  */
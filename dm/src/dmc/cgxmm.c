@@ -1547,6 +1547,8 @@ void cdvecfill(CodeBuilder& cdb, elem *e, regm_t *pretregs)
 
 bool xmmIsAligned(elem *e)
 {
+    if (tyvector(e->Ety) && e->Eflags & EFLAGS_unaligned)
+        return false;       // e.g. array elements accessed by the vectorizer
     if (tyvector(e->Ety) && e->Eoper == OPvar)
     {
         Symbol *s = e->EV.sp.Vsym;
@@ -22,6 +22,7 @@
 #include        "code.h"
 #include        "global.h"
 #include        "type.h"
+#include        "xmm.h"
 #if SCPP
 #include        "exh.h"
 #endif
@@ -2987,7 +2988,7 @@ void cdind(CodeBuilder& cdb,elem *e,regm_t *pretregs)
         if (retregs & XMMREGS)
         {
             assert(sz == 4 || sz == 8 || sz == 16 || sz == 32); // float, double or vector
-            cs.Iop = xmmload(tym);
+            cs.Iop = xmmload(tym, xmmIsAligned(e));
             cs.Irex &= ~REX_W;
             code_newreg(&cs,reg - XMM0);
             checkSetVex(&cs,tym);
@@ -3514,6 +3515,38 @@ void cdstrcpy(CodeBuilder& cdb,elem *e,regm_t *pretregs)
     fixresult(cdb,e,mAX | mES,pretregs);
 }
 
+/*********************************
+ * Determine if numbytes should be copied or filled inline
+ * with XMM moves rather than with string instructions.
+ */
+
+#define XMM_THRESHOLD   256     // max bytes to move inline with XMM registers
+
+STATIC bool xmmmoveable(targ_size_t numbytes)
+{
+    return config.fpxmmregs && !I16 && !(config.flags4 & CFG4space) &&
+           numbytes >= 16 && numbytes <= XMM_THRESHOLD;
+}
+
+/*********************************
+ * Copy (sreg != NOREG) or fill (from xreg) numbytes at [dreg] with
+ * unaligned 16 byte moves. A tail that is not a multiple of 16 is done
+ * by overlapping the last move with the one before it.
+ */
+
+STATIC void xmmmove(CodeBuilder& cdb, unsigned dreg, unsigned sreg, unsigned xreg, targ_size_t numbytes)
+{
+    assert(numbytes >= 16);
+    for (targ_size_t offset = 0; offset < numbytes; offset += 16)
+    {
+        if (offset + 16 > numbytes)
+            offset = numbytes - 16;
+        if (sreg != NOREG)              // MOVDQU xreg,offset[sreg]
+            cdb.genc1(LODDQU,buildModregrm(2,xreg - XMM0,sreg),FLconst,offset);
+        cdb.genc1(STODQU,buildModregrm(2,xreg - XMM0,dreg),FLconst,offset); // MOVDQU offset[dreg],xreg
+    }
+}
+
 /*********************************
  * Generate code for memcpy(s1,s2,n) intrinsic.
  *  OPmemcpy
@@ -3543,6 +3576,32 @@ void cdmemcpy(CodeBuilder& cdb,elem *e,regm_t *pretregs)
     elem *e2 = e->E2;
     assert(e2->Eoper == OPparam);
 
+    if (e2->E2->Eoper == OPconst && xmmmoveable(el_tolong(e2->E2)) &&
+        tybasic(e->E1->Ety) == TYnptr && tybasic(e2->E1->Ety) == TYnptr)
+    {
+        /*      MOVDQU  XMM,0[s2]
+         *      MOVDQU  0[s1],XMM
+         *      ...
+         */
+        targ_size_t numbytes = el_tolong(e2->E2);
+        regm_t retregs2 = allregs;
+        codelem(cdb,e2->E1,&retregs2,FALSE);
+        freenode(e2->E2);
+        freenode(e2);
+
+        regm_t retregs1 = *pretregs & allregs & ~retregs2;
+        if (!retregs1)
+            retregs1 = allregs & ~retregs2;
+        scodelem(cdb,e->E1,&retregs1,retregs2,FALSE);
+
+        regm_t xregs = XMMREGS;
+        unsigned xreg;
+        allocreg(cdb,&xregs,&xreg,TYdouble);
+        xmmmove(cdb,findreg(retregs1),findreg(retregs2),xreg,numbytes);
+        fixresult(cdb,e,retregs1,pretregs);
+        return;
+    }
+
     // Get s2 into DX:SI
     regm_t retregs2 = mSI;
     tym_t ty2 = e2->E1->Ety;
@@ -3700,6 +3759,38 @@ void cdmemset(CodeBuilder& cdb,elem *e,regm_t *pretregs)
     if (e2->E1->Eoper == OPconst)
     {
         numbytes = el_tolong(e2->E1);
+        if (numbytes >= 32 && xmmmoveable(numbytes) && e2E2isConst &&
+            tybasic(e->E1->Ety) == TYnptr)
+        {
+            /*      PXOR    XMM,XMM         ; or MOVD XMM,vreg / PSHUFD XMM,XMM,0
+             *      MOVDQU  0[reg],XMM
+             *      ...
+             */
+            retregs1 = *pretregs & allregs;
+            if (!retregs1)
+                retregs1 = ALLREGS;
+            codelem(cdb,e->E1,&retregs1,FALSE);
+            reg = findreg(retregs1);
+
+            regm_t xregs = XMMREGS;
+            unsigned xreg;
+            allocreg(cdb,&xregs,&xreg,TYdouble);
+            const unsigned x = xreg - XMM0;
+            if (value == 0)
+                cdb.gen2(PXOR,modregxrmx(3,x,x));               // PXOR XMM,XMM
+            else
+            {
+                regwithvalue(cdb, ALLREGS & ~retregs1, value & 0xFFFFFFFF, &vreg, 0);
+                cdb.gen2(LODD,modregxrmx(3,x,vreg));            // MOVD XMM,vreg
+                cdb.genc2(PSHUFD,modregxrmx(3,x,x),0);          // PSHUFD XMM,XMM,0
+            }
+            freenode(e2->E2);
+            freenode(e2);
+
+            xmmmove(cdb,reg,NOREG,xreg,numbytes);
+            fixresult(cdb,e,retregs1,pretregs);
+            return;
+        }
         if (numbytes <= REP_THRESHOLD &&
             !I16 &&                     // doesn't work for 16 bits
             e2E2isConst)
@@ -3969,7 +4060,15 @@ void cdstreq(CodeBuilder& cdb,elem *e,regm_t *pretregs)
         cdb.gen1(0x1E);                     // PUSH DS
         cdb.gen2(0x8E,modregrm(3,SEG_DS,CX));    // MOV DS,CX
     }
-    if (numbytes <= REGSIZE * (6 + (REGSIZE == 4)))
+    bool xmm = !need_DS && srcregs == mSI && dstregs == mDI && xmmmoveable(numbytes);
+    if (xmm)
+    {
+        regm_t xregs = XMMREGS;
+        unsigned xreg;
+        allocreg(cdb,&xregs,&xreg,TYdouble);
+        xmmmove(cdb,DI,SI,xreg,numbytes);       // DI is not advanced
+    }
+    else if (numbytes <= REGSIZE * (6 + (REGSIZE == 4)))
     {
         while (numbytes >= REGSIZE)
         {
@@ -4020,7 +4119,8 @@ void cdstreq(CodeBuilder& cdb,elem *e,regm_t *pretregs)
     if (*pretregs)
     {   // ES:DI points past what we want
 
-        cdb.genc2(0x81,(rex << 16) | modregrm(3,5,DI), type_size(e->ET));   // SUB DI,numbytes
+        if (!xmm)
+            cdb.genc2(0x81,(rex << 16) | modregrm(3,5,DI), type_size(e->ET));   // SUB DI,numbytes
         regm_t retregs = mDI;
         if (*pretregs & mMSW && !(config.exe & EX_flat))
             retregs |= mES;
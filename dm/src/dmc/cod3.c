@@ -1211,6 +1211,20 @@ struct CaseVal
         const CaseVal *c2 = (const CaseVal *)q;
         return (c1->val < c2->val) ? -1 : ((c1->val == c2->val) ? 0 : 1);
     }
+
+    /* Sort function for qsort(), most frequently executed target first */
+    static int
+#if __DMC__
+                __cdecl
+#endif
+                cmpweight(const void *p, const void *q)
+    {
+        const CaseVal *c1 = (const CaseVal *)p;
+        const CaseVal *c2 = (const CaseVal *)q;
+        if (c1->target->Bweight != c2->target->Bweight)
+            return (c1->target->Bweight > c2->target->Bweight) ? -1 : 1;
+        return cmp(p, q);
+    }
 };
 }
 
@@ -1414,6 +1428,12 @@ void doswitch(CodeBuilder& cdb, block *b)
         // Sort cases so we can do a runtime binary search
         qsort(casevals, ncases, sizeof(CaseVal), &CaseVal::cmp);
 
+        /* ifthen() does a linear sequence of compares in this case, so
+         * with a profile put the cases that ran most often first.
+         */
+        if ((ncases < 4 || !(config.flags4 & CFG4speed)) && profile_count(funcsym_p))
+            qsort(casevals, ncases, sizeof(CaseVal), &CaseVal::cmpweight);
+
         //for (unsigned n = 0; n < ncases; n++)
             //printf("casevals[%lld] = x%x\n", n, casevals[n].val);
 
@@ -27,6 +27,9 @@ typedef unsigned char eflags_t;
 enum
 {
     EFLAGS_variadic = 1,   // variadic function call
+    EFLAGS_unaligned = 2,  // vector may not be aligned to its size
+    EFLAGS_likely = 4,     // __builtin_expect() says value is likely nonzero
+    EFLAGS_unlikely = 8,   // __builtin_expect() says value is likely zero
 };
 
 typedef unsigned pef_flags_t;
@@ -166,6 +166,9 @@ static Outbuffer *section_names;
 // Hash table for section_names
 AArray *section_names_hashtable;
 
+// Maps section_names index to the segment created for it by ElfObj::getsegment()
+static AArray *section_segs_hashtable;
+
 int jmpseg;
 
 /* ====================== Cached Strings in section_names ================= */
@@ -370,60 +373,6 @@ IDXSTR Obj::addstr(Outbuffer *strtab, const char *str)
     return idx;
 }
 
-/*******************************
- * Find a string in a string table
- * Input:
- *      strtab  =       string table for entry
- *      str     =       string to find
- *
- * Returns index into the specified string table or 0.
- */
-
-static IDXSTR elf_findstr(Outbuffer *strtab, const char *str, const char *suffix)
-{
-    //printf("elf_findstr(strtab = %p, str = %s, suffix = %s\n", strtab, str ? str : "", suffix ? suffix : "");
-
-    size_t len = strlen(str);
-
-    // Combine str~suffix and have buf point to the combination
-#ifdef DEBUG
-    char tmpbuf[25];    // to exercise the alloca() code path
-#else
-    char tmpbuf[1024];  // the alloca() code path is slow
-#endif
-    const char *buf;
-    if (suffix)
-    {
-        size_t suffixlen = strlen(suffix);
-        if (len + suffixlen >= sizeof(tmpbuf))
-        {
-             buf = (char *)alloca(len + suffixlen + 1);
-             assert(buf);
-        }
-        else
-        {
-             buf = tmpbuf;
-        }
-        memcpy((char *)buf, str, len);
-        memcpy((char *)buf + len, suffix, suffixlen + 1);
-        len += suffixlen;
-    }
-    else
-        buf = str;
-
-    // Linear search, slow
-    const char *ent = (char *)strtab->buf+1;
-    const char *pend = ent+strtab->size() - 1;
-    while (ent + len < pend)
-    {
-        if (memcmp(buf, ent, len + 1) == 0)
-            return ent - (const char *)strtab->buf;
-        ent = (const char *)memchr(ent, 0, pend - ent);
-        ent += 1;
-    }
-    return 0;                   // never found match
-}
-
 /*******************************
  * Output a mangled string into the symbol string table
  * Input:
@@ -790,6 +739,9 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
         if (section_names_hashtable)
             delete section_names_hashtable;
         section_names_hashtable = new AArray(&ti_idxstr, sizeof(IDXSTR));
+        if (section_segs_hashtable)
+            delete section_segs_hashtable;
+        section_segs_hashtable = new AArray(&ti_idxstr, sizeof(int));
 
         // name,type,flags,addr,offset,size,link,info,addralign,entsize
         elf_newsection2(0,               SHT_NULL,   0,                 0,0,0,0,0, 0,0);
@@ -838,6 +790,9 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
         if (section_names_hashtable)
             delete section_names_hashtable;
         section_names_hashtable = new AArray(&ti_idxstr, sizeof(IDXSTR));
+        if (section_segs_hashtable)
+            delete section_segs_hashtable;
+        section_segs_hashtable = new AArray(&ti_idxstr, sizeof(int));
 
         // name,type,flags,addr,offset,size,link,info,addralign,entsize
         elf_newsection2(0,               SHT_NULL,   0,                 0,0,0,0,0, 0,0);
@@ -1876,6 +1831,16 @@ int Obj::jmpTableSegment(Symbol *s)
     return seg;
 }
 
+/***********************************
+ * Returns:
+ *      segment for code unlikely to be executed, which the
+ *      GNU linker gathers together after the hot code
+ */
+int Obj::coldcodeseg()
+{
+    return ElfObj::getsegment(".text.unlikely", NULL, SHT_PROGBITS, SHF_ALLOC|SHF_EXECINSTR, 4);
+}
+
 /****************************************
  * If `comdatseg` has a group, add `secidx` to the group.
  * Params:
@@ -1987,6 +1952,9 @@ int ElfObj::getsegment(const char *name, const char *suffix, int type, int flags
     {   // this section name already exists
         section_names->setsize(namidx);                 // remove addition
         namidx = *pidx;
+        int *pseg = (int *)section_segs_hashtable->in(&namidx);
+        if (pseg)
+            return *pseg;
         for (int seg = CODE; seg <= seg_count; seg++)
         {                               // should be in segment table
             if (MAP_SEG2SEC(seg)->sh_name == namidx)
@@ -2004,6 +1972,7 @@ int ElfObj::getsegment(const char *name, const char *suffix, int type, int flags
     SecHdrTab[shtidx].sh_addralign = align;
     IDXSYM symidx = elf_addsym(0, 0, 0, STT_SECTION, STB_LOCAL, shtidx);
     int seg = elf_getsegment2(shtidx, symidx, 0);
+    *(int *)section_segs_hashtable->get(&namidx) = seg;
     //printf("-ElfObj::getsegment() = %d\n", seg);
     return seg;
 }
@@ -40,6 +40,7 @@ enum
 static int flowxx;              /* one of the above values              */
 
 static vec_t ambigsym = NULL;
+static vec_t livexit;           /* variables live on exit, for flowlv() */
 
 STATIC void rdgenkill(void);
 STATIC unsigned numdefelems(elem *n, unsigned *pnum_unambig_def);
@@ -60,6 +61,76 @@ STATIC void accumlv(vec_t GEN , vec_t KILL , elem *n);
 STATIC void accumvbe(vec_t GEN , vec_t KILL , elem *n);
 STATIC void accumrd(vec_t GEN , vec_t KILL , elem *n);
 STATIC void flowaecp(void);
+STATIC void flowsolve(bool backward, unsigned first, unsigned dim, bool (*transfer)(block *));
+STATIC bool rdtransfer(block *b);
+STATIC bool aecptransfer(block *b);
+STATIC bool lvtransfer(block *b);
+STATIC bool vbetransfer(block *b);
+
+/***************** WORKLIST SOLVER *********************/
+
+/************************************
+ * Iterate a data flow problem to its fixed point.
+ * Rather than sweeping every block until nothing changes, only
+ * blocks whose inputs may have changed are recomputed.
+ * Bit j of the pending set stands for dfo[j] (forward problems) or
+ * dfo[dfotop - 1 - j] (backward problems), so scanning it upward
+ * visits blocks in the same order the old sweeps did.
+ * Input:
+ *      backward        true if information flows from successors
+ *                      to predecessors
+ *      first           blocks before this position in the sweep
+ *                      order are fixed and never recomputed
+ *      dim             vector size in words, for go.work
+ *      transfer        recompute one block, return true if its
+ *                      output changed
+ */
+
+STATIC void flowsolve(bool backward, unsigned first, unsigned dim, bool (*transfer)(block *))
+{
+        if (first >= dfotop)
+                return;
+
+        vec_t pending = vec_calloc(dfotop);
+        for (unsigned j = first; j < dfotop; j++)
+                vec_setbit(j,pending);
+
+        unsigned long visits = 0;
+        unsigned npending = dfotop - first;
+        unsigned j = first;
+        while (npending)
+        {
+                j = vec_index(j,pending);
+                if (j >= dfotop)                // wrap around for another pass
+                {       j = vec_index(0,pending);
+                        assert(j < dfotop);
+                }
+                vec_clearbit(j,pending);
+                npending--;
+                visits++;
+
+                block *b = dfo[backward ? dfotop - 1 - j : j];
+                if (!(*transfer)(b))
+                        continue;
+
+                // Anything that depends on b has to be looked at again
+                for (list_t bl = backward ? b->Bpred : b->Bsucc; bl; bl = list_next(bl))
+                {       block *bn = list_block(bl);
+                        unsigned i = bn->Bdfoidx;
+
+                        if (i >= dfotop || dfo[i] != bn)
+                                continue;       // not reachable
+                        unsigned k = backward ? dfotop - 1 - i : i;
+                        if (k >= first && !vec_testbit(k,pending))
+                        {       vec_setbit(k,pending);
+                                npending++;
+                        }
+                }
+        }
+        vec_free(pending);
+        go.work += visits * dim;
+        cmes3("flowsolve: %lu visits for %u blocks\n",visits,dfotop);
+}
 
 /***************** REACHING DEFINITIONS *********************/
 
@@ -83,39 +154,12 @@ void flowrd()
         /* The transfer equation is:                                    */
         /*      Bin = union of Bouts of all predecessors of B.          */
         /*      Bout = (Bin - Bkill) | Bgen                             */
-        /* Using Ullman's algorithm:                                    */
+        /* Using a worklist:                                            */
 
         for (unsigned i = 0; i < dfotop; i++)
                 vec_copy(dfo[i]->Boutrd,dfo[i]->Bgen);
 
-        bool anychng;
-        vec_t tmp = vec_calloc(go.deftop);
-        do
-        {       anychng = FALSE;
-                for (unsigned i = 0; i < dfotop; i++)    // for each block
-                {
-                        block *b = dfo[i];
-
-                        /* Binrd = union of Boutrds of all predecessors of b */
-                        vec_clear(b->Binrd);
-                        if (b->BC != BCcatch /*&& b->BC != BCjcatch*/)
-                        {
-                            /* Set Binrd to 0 to account for:
-                             * i = 0;
-                             * try { i = 1; throw; } catch () { x = i; }
-                             */
-                            for (list_t bp = b->Bpred; bp; bp = list_next(bp))
-                                vec_orass(b->Binrd,list_block(bp)->Boutrd);
-                        }
-                        /* Bout = (Bin - Bkill) | Bgen */
-                        vec_sub(tmp,b->Binrd,b->Bkill);
-                        vec_orass(tmp,b->Bgen);
-                        if (!anychng)
-                                anychng = !vec_equal(tmp,b->Boutrd);
-                        vec_copy(b->Boutrd,tmp);
-                }
-        } while (anychng);              /* while any changes to Boutrd  */
-        vec_free(tmp);
+        flowsolve(false,0,vec_dim(startblock->Boutrd),rdtransfer);
 
 #if 0
         dbg_printf("Reaching definitions\n");
@@ -131,6 +175,29 @@ void flowrd()
 #endif
 }
 
+/************************************
+ * Recompute Binrd and Boutrd for block b.
+ * Returns:
+ *      true if Boutrd changed
+ */
+
+STATIC bool rdtransfer(block *b)
+{
+        /* Binrd = union of Boutrds of all predecessors of b */
+        vec_clear(b->Binrd);
+        if (b->BC != BCcatch /*&& b->BC != BCjcatch*/)
+        {
+            /* Set Binrd to 0 to account for:
+             * i = 0;
+             * try { i = 1; throw; } catch () { x = i; }
+             */
+            for (list_t bp = b->Bpred; bp; bp = list_next(bp))
+                vec_orass(b->Binrd,list_block(bp)->Boutrd);
+        }
+        /* Bout = (Bin - Bkill) | Bgen */
+        return vec_subor(b->Boutrd,b->Binrd,b->Bkill,b->Bgen);
+}
+
 /***************************
  * Compute Bgen and Bkill for RDs.
  */
@@ -432,9 +499,7 @@ void flowcp()
  */
 
 STATIC void flowaecp()
-{       vec_t tmp;
-        bool anychng;
-
+{
         aecpgenkill();          /* Compute Bgen and Bkill for AEs or CPs */
         if (go.exptop <= 1)        /* if no expressions                    */
                 return;
@@ -442,7 +507,7 @@ STATIC void flowaecp()
         /* The transfer equation is:                    */
         /*      Bin = & Bout(all predecessors P of B)   */
         /*      Bout = (Bin - Bkill) | Bgen             */
-        /* Using Ullman's algorithm:                    */
+        /* Using a worklist:                            */
 
         vec_clear(startblock->Bin);
         vec_copy(startblock->Bout,startblock->Bgen); /* these never change */
@@ -464,79 +529,48 @@ STATIC void flowaecp()
                 }
         }
 
-        tmp = vec_calloc(go.exptop);
-        do
-        {   anychng = FALSE;
+        flowsolve(false,1,vec_dim(startblock->Bout),aecptransfer);
+}
 
-            // For all blocks except startblock
-            for (unsigned i = 1; i < dfotop; i++)
-            {   block *b = dfo[i];
-                list_t bl = b->Bpred;
-                block *bp;
+/************************************
+ * Recompute Bin, Bout and Bout2 for AEs or CPs for block b.
+ * Returns:
+ *      true if Bout or Bout2 changed
+ */
 
-                // Bin = & of Bout of all predecessors
-                // Bout = (Bin - Bkill) | Bgen
+STATIC bool aecptransfer(block *b)
+{
+        list_t bl = b->Bpred;
+        block *bp;
 
-                assert(bl);     // it must have predecessors
-                bp = list_block(bl);
-                if (bp->BC == BCiftrue && bp->nthSucc(0) != b)
-                    vec_copy(b->Bin,bp->Bout2);
-                else
-                    vec_copy(b->Bin,bp->Bout);
-                while (TRUE)
-                {   bl = list_next(bl);
-                    if (!bl)
-                        break;
-                    bp = list_block(bl);
-                    if (bp->BC == BCiftrue && bp->nthSucc(0) != b)
-                        vec_andass(b->Bin,bp->Bout2);
-                    else
-                        vec_andass(b->Bin,bp->Bout);
-                }
+        // Bin = & of Bout of all predecessors
+        // Bout = (Bin - Bkill) | Bgen
 
-                if (anychng)
-                {   vec_sub(b->Bout,b->Bin,b->Bkill);
-                    vec_orass(b->Bout,b->Bgen);
-                }
-                else
-                {   vec_sub(tmp,b->Bin,b->Bkill);
-                    vec_orass(tmp,b->Bgen);
-                    if (!vec_equal(tmp,b->Bout))
-                    {   // Swap Bout and tmp instead of
-                        // copying tmp over Bout
-                        vec_t v;
-
-                        v = tmp;
-                        tmp = b->Bout;
-                        b->Bout = v;
-                        anychng = TRUE;
-                    }
-                }
+        assert(bl);     // it must have predecessors
+        bp = list_block(bl);
+        if (bp->BC == BCiftrue && bp->nthSucc(0) != b)
+            vec_copy(b->Bin,bp->Bout2);
+        else
+            vec_copy(b->Bin,bp->Bout);
+        while (TRUE)
+        {   bl = list_next(bl);
+            if (!bl)
+                break;
+            bp = list_block(bl);
+            if (bp->BC == BCiftrue && bp->nthSucc(0) != b)
+                vec_andass(b->Bin,bp->Bout2);
+            else
+                vec_andass(b->Bin,bp->Bout);
+        }
 
-                if (b->BC == BCiftrue)
-                {   // Bout2 = (Bin - Bkill2) | Bgen2
-                    if (anychng)
-                    {   vec_sub(b->Bout2,b->Bin,b->Bkill2);
-                        vec_orass(b->Bout2,b->Bgen2);
-                    }
-                    else
-                    {   vec_sub(tmp,b->Bin,b->Bkill2);
-                        vec_orass(tmp,b->Bgen2);
-                        if (!vec_equal(tmp,b->Bout2))
-                        {   // Swap Bout and tmp instead of
-                            // copying tmp over Bout2
-                            vec_t v;
-
-                            v = tmp;
-                            tmp = b->Bout2;
-                            b->Bout2 = v;
-                            anychng = TRUE;
-                        }
-                    }
-                }
-            }
-        } while (anychng);
-        vec_free(tmp);
+        bool anychng = vec_subor(b->Bout,b->Bin,b->Bkill,b->Bgen);
+
+        if (b->BC == BCiftrue)
+        {   // Bout2 = (Bin - Bkill2) | Bgen2
+            if (vec_subor(b->Bout2,b->Bin,b->Bkill2,b->Bgen2))
+                anychng = TRUE;
+        }
+        return anychng;
 }
 
 /******************************
@@ -1218,10 +1252,7 @@ STATIC void accumaecpx(elem *n)
  */
 
 void flowlv()
-{       vec_t tmp,livexit;
-        bool anychng;
-        unsigned cnt;
-
+{
         lvgenkill();            /* compute Bgen and Bkill for LVs.      */
         //assert(globsym.top);  /* should be at least some symbols      */
 
@@ -1237,47 +1268,16 @@ void flowlv()
         /* The transfer equation is:                            */
         /*      Bin = (Bout - Bkill) | Bgen                     */
         /*      Bout = union of Bin of all successors to B.     */
-        /* Using Ullman's algorithm:                            */
+        /* Using a worklist:                                    */
 
         for (unsigned i = 0; i < dfotop; i++)            // for each block B
         {
                 vec_copy(dfo[i]->Binlv,dfo[i]->Bgen);   /* Binlv = Bgen */
         }
 
-        tmp = vec_calloc(globsym.top);
-        cnt = 0;
-        do
-        {       anychng = FALSE;
-
-                /* For each block B in reverse DFO order        */
-                for (unsigned i = dfotop; i--;)
-                {       block *b = dfo[i];
-                        list_t bl = b->Bsucc;
-
-                        /* Bout = union of Bins of all successors to B. */
-                        if (bl)
-                        {       vec_copy(b->Boutlv,list_block(bl)->Binlv);
-                                while ((bl = list_next(bl)) != NULL)
-                                {   vec_orass(b->Boutlv,list_block(bl)->Binlv);
-                                }
-                        }
-                        else /* no successors, Boutlv = livexit */
-                        {   //assert(b->BC==BCret||b->BC==BCretexp||b->BC==BCexit);
-                            vec_copy(b->Boutlv,livexit);
-                        }
-
-                        /* Bin = (Bout - Bkill) | Bgen                  */
-                        vec_sub(tmp,b->Boutlv,b->Bkill);
-                        vec_orass(tmp,b->Bgen);
-                        if (!anychng)
-                                anychng = !vec_equal(tmp,b->Binlv);
-                        vec_copy(b->Binlv,tmp);
-                }
-                cnt++;
-                assert(cnt < 50);
-        } while (anychng);
-        vec_free(tmp);
+        flowsolve(true,0,(globsym.top + VECMASK) >> VECSHIFT,lvtransfer);
         vec_free(livexit);
+        livexit = NULL;
 #if 0
         dbg_printf("Live variables\n");
         for (unsigned i = 0; i < dfotop; i++)
@@ -1293,6 +1293,32 @@ void flowlv()
 #endif
 }
 
+/************************************
+ * Recompute Boutlv and Binlv for block b.
+ * Returns:
+ *      true if Binlv changed
+ */
+
+STATIC bool lvtransfer(block *b)
+{
+        list_t bl = b->Bsucc;
+
+        /* Bout = union of Bins of all successors to B. */
+        if (bl)
+        {       vec_copy(b->Boutlv,list_block(bl)->Binlv);
+                while ((bl = list_next(bl)) != NULL)
+                {   vec_orass(b->Boutlv,list_block(bl)->Binlv);
+                }
+        }
+        else /* no successors, Boutlv = livexit */
+        {   //assert(b->BC==BCret||b->BC==BCretexp||b->BC==BCexit);
+            vec_copy(b->Boutlv,livexit);
+        }
+
+        /* Bin = (Bout - Bkill) | Bgen                  */
+        return vec_subor(b->Binlv,b->Boutlv,b->Bkill,b->Bgen);
+}
+
 /***********************************
  * Compute Bgen and Bkill for LVs.
  * Allocate Binlv and Boutlv vectors.
@@ -1525,9 +1551,7 @@ STATIC void accumlv(vec_t GEN,vec_t KILL,elem *n)
  */
 
 void flowvbe()
-{       vec_t tmp;
-        bool anychng;
-
+{
         flowxx = VBE;
         aecpgenkill();          /* compute Bgen and Bkill for VBEs      */
         if (go.exptop <= 1)        /* if no candidates for VBEs            */
@@ -1539,7 +1563,7 @@ void flowvbe()
         /* The transfer equation is:                    */
         /*      Bout = & Bin(all successors S of B)     */
         /*      Bin =(Bout - Bkill) | Bgen              */
-        /* Using Ullman's algorithm:                    */
+        /* Using a worklist:                            */
 
         /*dbg_printf("defkill = "); vec_println(go.defkill);
         dbg_printf("starkill = "); vec_println(go.starkill);*/
@@ -1561,38 +1585,36 @@ void flowvbe()
                 vec_orass(b->Bin,b->Bgen);
         }
 
-        tmp = vec_calloc(go.exptop);
-        do
-        {       anychng = FALSE;
-
-                /* for all blocks except return blocks in reverse dfo order */
-                for (unsigned i = dfotop; i--;)
-                {       block *b = dfo[i];
-                        list_t bl;
+        flowsolve(true,0,vec_dim(startblock->Bin),vbetransfer);
+}
 
-                        if (b->BC == BCret || b->BC == BCretexp || b->BC == BCexit)
-                                continue;
+/************************************
+ * Recompute Bout and Bin for VBEs for block b.
+ * Returns:
+ *      true if Bin changed
+ */
 
-                        /* Bout = & of Bin of all successors */
-                        bl = b->Bsucc;
-                        assert(bl);     /* must have successors         */
-                        vec_copy(b->Bout,list_block(bl)->Bin);
-                        while (TRUE)
-                        {   bl = list_next(bl);
-                            if (!bl)
-                                break;
-                            vec_andass(b->Bout,list_block(bl)->Bin);
-                        }
+STATIC bool vbetransfer(block *b)
+{
+        list_t bl;
+
+        /* return blocks never change   */
+        if (b->BC == BCret || b->BC == BCretexp || b->BC == BCexit)
+                return false;
+
+        /* Bout = & of Bin of all successors */
+        bl = b->Bsucc;
+        assert(bl);     /* must have successors         */
+        vec_copy(b->Bout,list_block(bl)->Bin);
+        while (TRUE)
+        {   bl = list_next(bl);
+            if (!bl)
+                break;
+            vec_andass(b->Bout,list_block(bl)->Bin);
+        }
 
-                        /* Bin = (Bout - Bkill) | Bgen  */
-                        vec_sub(tmp,b->Bout,b->Bkill);
-                        vec_orass(tmp,b->Bgen);
-                        if (!anychng)
-                                anychng = !vec_equal(tmp,b->Bin);
-                        vec_copy(b->Bin,tmp);
-                }
-        } while (anychng);      /* while any changes occurred to any Bin */
-        vec_free(tmp);
+        /* Bin = (Bout - Bkill) | Bgen  */
+        return vec_subor(b->Bin,b->Bout,b->Bkill,b->Bgen);
 }
 
 /*************************************
@@ -448,6 +448,10 @@ int binary(const char *p, size_t len, const char ** tab, int high);
 void go_term();
 int go_flag(char *cp);
 void optfunc();
+void profile_term();
+unsigned profile_count(Symbol *s);
+bool profile_cold(Symbol *s);
+bool profile_coldcall(Symbol *scaller, Symbol *scallee);
 
 /* filename.c */
 #if !MARS
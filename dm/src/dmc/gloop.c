@@ -114,6 +114,8 @@ STATIC int countrefs2(elem *e);
 STATIC void elimspec(loop *l);
 STATIC void elimspecwalk(elem **pn);
 static bool loopunroll(loop *l);
+static bool loopunrollblocks(loop *l, int numblocks);
+static bool loopvectorize(loop *l);
 
 static  bool addblk;                    /* if TRUE, then we added a block */
 
@@ -783,6 +785,27 @@ restart:
 
     doflow = TRUE;                      /* do flow analysis             */
 
+    if (go.mfoptim & MFvec && config.fpxmmregs)
+    {
+        cmes("Starting loop vectorization\n");
+        for (loop *l = startloop; l; l = ln)
+        {
+            ln = l->Lnext;
+            if (loopvectorize(l))
+            {
+                compdfo();                      // compute depth-first order
+                blockinit();
+                compdom();
+                findloops(&startloop);          // recompute block info
+                doflow = TRUE;
+                if (ln)
+                {   ln = startloop;         // start over
+                    file_progress();
+                }
+            }
+        }
+    }
+
     if (go.mfoptim & MFtime)
     {
         cmes("Starting loop unrolling\n");
@@ -3473,6 +3496,596 @@ STATIC void elimspecwalk(elem **pn)
   }
 }
 
+/*********************************
+ * Vector type with 16 byte size holding elements of type ty.
+ * Returns:
+ *      vector type, 0 if none
+ */
+
+STATIC tym_t vectype(tym_t ty)
+{
+    switch (tybasic(ty))
+    {
+        case TYfloat:   return TYfloat4;
+        case TYdouble:
+        case TYdouble_alias:
+                        return TYdouble2;
+    }
+    if (tyintegral(ty))
+    {
+        switch (tysize(ty))
+        {
+            case 4:     return tyuns(ty) ? TYulong4 : TYlong4;
+            case 8:     return tyuns(ty) ? TYullong2 : TYllong2;
+        }
+    }
+    return 0;
+}
+
+/*********************************
+ * Determine if e is the index v scaled by sz,
+ * i.e. (v * sz) or (v << log2(sz)), possibly widened.
+ */
+
+STATIC bool vecindex(elem *e, Symbol *v, unsigned sz)
+{
+    while (e->Eoper == OPs32_64 || e->Eoper == OPu32_64)
+        e = e->E1;
+    if (e->Eoper == OPmul && e->E2->Eoper == OPconst && el_tolong(e->E2) == sz)
+        e = e->E1;
+    else if (e->Eoper == OPshl && e->E2->Eoper == OPconst && el_tolong(e->E2) < 8 &&
+             (1 << el_tolong(e->E2)) == sz)
+        e = e->E1;
+    else
+        return false;
+    while (e->Eoper == OPs32_64 || e->Eoper == OPu32_64)
+        e = e->E1;
+    return e->Eoper == OPvar && e->EV.sp.Vsym == v && !e->Ecount;
+}
+
+/*********************************
+ * Determine if e is the address of element v of an array of sz byte elements,
+ * i.e. (base + v * sz).
+ * Returns:
+ *      base, the address of the array, NULL if not
+ */
+
+STATIC elem *vecbase(elem *e, Symbol *v, unsigned sz)
+{
+    if (e->Eoper != OPadd || e->Ecount)
+        return NULL;
+    elem *base = e->E1;
+    if (!vecindex(e->E2,v,sz))
+    {
+        base = e->E2;
+        if (!vecindex(e->E1,v,sz))
+            return NULL;
+    }
+    if (base->Eoper == OPrelconst)
+        return base;
+
+    // A pointer the loop cannot change
+    if (base->Eoper == OPvar && base->EV.sp.Vsym != v && typtr(base->Ety))
+    {
+        Symbol *s = base->EV.sp.Vsym;
+        if (sytab[s->Sclass] & SCRD && s->Sflags & SFLunambig)
+            return base;
+    }
+    return NULL;
+}
+
+/*********************************
+ * Determine if the expression e can be computed for several consecutive
+ * values of index v at once, i.e. its array references are all indexed by v.
+ * Reading an array is only allowed if it is the array that is stored
+ * to, or if both are distinct arrays, so there are no dependencies
+ * between iterations.
+ */
+
+STATIC bool vecexp(elem *e, tym_t ty, Symbol *v, elem *sbase)
+{
+    if (tybasic(e->Ety) != tybasic(ty) || e->Ety & mTYvolatile || e->Ecount)
+        return false;
+    switch (e->Eoper)
+    {
+        case OPmul:
+        case OPdiv:
+            if (!tyfloating(ty))        // no packed integer multiply before SSE4.1
+                return false;
+            goto Lbin;
+
+        case OPand:
+        case OPor:
+        case OPxor:
+            if (tyfloating(ty))
+                return false;
+            goto Lbin;
+
+        case OPadd:
+        case OPmin:
+        Lbin:
+            return vecexp(e->E1,ty,v,sbase) && vecexp(e->E2,ty,v,sbase);
+
+        case OPind:
+        {
+            elem *base = vecbase(e->E1,v,tysize(ty));
+            if (!base)
+                return false;
+            if (el_match(base,sbase))
+                return true;
+            return base->Eoper == OPrelconst && sbase->Eoper == OPrelconst &&
+                   base->EV.sp.Vsym != sbase->EV.sp.Vsym;
+        }
+
+        case OPconst:
+            return true;
+
+        case OPvar:
+        {
+            // Loop invariant scalar, broadcast to all elements
+            Symbol *s = e->EV.sp.Vsym;
+            return s != v && sytab[s->Sclass] & SCRD && s->Sflags & SFLunambig;
+        }
+    }
+    return false;
+}
+
+/*********************************
+ * Rewrite expression e, already checked by vecexp(), into vector type tyv.
+ */
+
+STATIC void vecrewrite(elem *e, tym_t tyv)
+{
+    switch (e->Eoper)
+    {
+        case OPind:
+            e->Eflags |= EFLAGS_unaligned;      // arrays only have element alignment
+            break;
+
+        case OPconst:
+        case OPvar:
+        {
+            elem *e1 = el_calloc();
+            el_copy(e1,e);
+            e->Eoper = OPvecfill;
+            e->E1 = e1;
+            e->E2 = NULL;
+            break;
+        }
+
+        default:
+            vecrewrite(e->E1,tyv);
+            vecrewrite(e->E2,tyv);
+            break;
+    }
+    e->Ety = tyv;
+}
+
+/*********************************
+ * Vectorize loop if possible.
+ * Loops of the form:
+ *      for (v = initial; v < final; v++)
+ *          a[v] = b[v] op c[v];
+ * where initial and final are constants are rewritten so that each
+ * iteration computes 16 bytes worth of elements using vector types,
+ * and the (final - initial) % W iterations that are left over are done
+ * by scalar copies of the loop body placed in the preheader.
+ * Params:
+ *      l = loop to vectorize
+ * Returns:
+ *      true if loop was vectorized
+ */
+
+static bool loopvectorize(loop *l)
+{
+    const bool log = false;
+    if (log) printf("loopvectorize(%p)\n", l);
+
+    /* Like loopunroll(), only handle loops that consist of a head
+     * and tail, where the tail is the only exit.
+     */
+    int numblocks = 0;
+    int i;
+    foreach (i,dfotop,l->Lloop)
+        ++numblocks;
+    if (numblocks != 2 ||
+        vec_testbit(l->Lhead->Bdfoidx, l->Lexit) ||
+        !vec_testbit(l->Ltail->Bdfoidx, l->Lexit) ||
+        !l->Lpreheader)
+    {
+        if (log) printf("\tnot head and tail\n");
+        return false;
+    }
+
+    elem *ehead = l->Lhead->Belem;
+    elem *etail = l->Ltail->Belem;
+
+    // Tail must be of the form: (v < c)
+    if (!ehead ||
+        !etail ||
+        etail->Eoper != OPlt ||
+        etail->E1->Eoper != OPvar ||
+        etail->E2->Eoper != OPconst ||
+        !tyintegral(etail->E1->Ety) ||
+        tysize(etail->E1->Ety) > sizeof(targ_llong))
+    {
+        if (log) printf("\tnot (v < c)\n");
+        return false;
+    }
+
+    Symbol *v = etail->E1->EV.sp.Vsym;
+    if (!(sytab[v->Sclass] & SCRD) || !(v->Sflags & SFLunambig))
+    {
+        if (log) printf("\tnot SCRD\n");
+        return false;
+    }
+
+    // Head must be of the form: (store, increment)
+    if (ehead->Eoper != OPcomma)
+    {
+        if (log) printf("\tnot (store, increment)\n");
+        return false;
+    }
+    elem *estore = ehead->E1;
+    elem *einc = ehead->E2;
+
+    elem *einitial;
+    elem *eincrement;
+    extern bool findloopparameters(elem* erel, elem*& rdeq, elem*& rdinc);
+    if (!findloopparameters(etail, einitial, eincrement) ||
+        eincrement != einc ||
+        !(eincrement->Eoper == OPpostinc || eincrement->Eoper == OPaddass) ||
+        el_tolong(eincrement->E2) != 1)
+    {
+        if (log) printf("\tnot v++\n");
+        return false;
+    }
+
+    // Store must be of the form: (*(base + v * sz) = e)
+    tym_t ty = estore->Ety;
+    tym_t tyv = vectype(ty);
+    if (estore->Eoper != OPeq ||
+        !tyv ||
+        ty & mTYvolatile ||
+        estore->E1->Eoper != OPind ||
+        tybasic(estore->E1->Ety) != tybasic(ty))
+    {
+        if (log) printf("\tnot vector store\n");
+        return false;
+    }
+    unsigned sz = tysize(ty);
+    elem *sbase = vecbase(estore->E1->E1,v,sz);
+    if (!sbase || !vecexp(estore->E2,ty,v,sbase))
+    {
+        if (log) printf("\tnot vector expression\n");
+        return false;
+    }
+
+    targ_llong initial = el_tolong(einitial->E2);
+    targ_llong final = el_tolong(etail->E2);
+    targ_llong W = tysize(tyv) / sz;      // elements per vector
+    if (initial < 0 || final - initial < 2 * W)
+    {
+        if (log) printf("\ttoo few iterations\n");
+        return false;
+    }
+
+    if (log)
+    {
+        printf("Vectorizing:\n");
+        printf("  head:\t"); WReqn(ehead); printf("\n");
+        printf("  tail:\t"); WReqn(etail); printf("\n");
+    }
+
+    /* Peel off the left over iterations into the preheader,
+     * it is only executed once and always falls into the head.
+     */
+    for (targ_llong n = (final - initial) % W; n; --n)
+        l->Lpreheader->Belem = el_combine(l->Lpreheader->Belem, el_copytree(ehead));
+
+    vecrewrite(estore->E2,tyv);
+    estore->E1->Ety = tyv;
+    estore->E1->Eflags |= EFLAGS_unaligned;
+    estore->Ety = tyv;
+    eincrement->E2->EV.Vllong = W;
+
+    go.changes++;
+    return true;
+}
+
+/*********************************
+ * Determine if elem x is in tree e.
+ */
+
+STATIC bool el_intree(elem *e, elem *x)
+{
+    while (1)
+    {
+        if (e == x)
+            return true;
+        if (!OTleaf(e->Eoper))
+        {
+            if (OTbinary(e->Eoper) && el_intree(e->E2, x))
+                return true;
+            e = e->E1;
+        }
+        else
+            return false;
+    }
+}
+
+/*********************************
+ * Find loop condition (v < c) at the end of tail expression e.
+ */
+
+STATIC elem *unrollrel(elem *e)
+{
+    while (e && e->Eoper == OPcomma)
+        e = e->E2;
+    return e;
+}
+
+/*********************************
+ * Unroll a loop of more than two blocks, used by loopunroll().
+ * The loop must have only one exit, at the tail, which tests (v < c),
+ * and v must be incremented once per iteration by a constant so the
+ * trip count is known.
+ * The loop body is copied factor-1 times, and the tail test in all
+ * but the last copy is replaced by a goto the next copy's head. The
+ * factor is the largest of 8, 4 or 2 that evenly divides the trip count
+ * and keeps the unrolled loop small, so no remainder iterations are needed.
+ * Params:
+ *      l = loop to unroll
+ *      numblocks = number of blocks in l
+ * Returns:
+ *      true if loop was unrolled
+ */
+
+static bool loopunrollblocks(loop *l, int numblocks)
+{
+    const bool log = false;
+    if (log) printf("loopunrollblocks(%p, %d)\n", l, numblocks);
+
+    block *head = l->Lhead;
+    block *tail = l->Ltail;
+    enum { BLOCKSMAX = 8, COSTMAX = 200 };
+    if (numblocks > BLOCKSMAX || head == tail)
+        return false;
+
+    /* tail must be the sole exit block, branching back to head if true
+     */
+    if (tail->BC != BCiftrue ||
+        list_block(tail->Bsucc) != head ||
+        vec_testbit(list_block(list_next(tail->Bsucc))->Bdfoidx, l->Lloop))
+    {
+        if (log) printf("\ttail is not (if (v < c) goto head)\n");
+        return false;
+    }
+
+    extern int el_length(elem *e);
+    block *lb[BLOCKSMAX];
+    int cost = 0;
+    int n = 0;
+    int i;
+    foreach (i,dfotop,l->Lloop)
+    {
+        block *b = dfo[i];
+        if (b != tail && vec_testbit(i, l->Lexit))
+        {
+            if (log) printf("\tmore than one exit\n");
+            return false;
+        }
+        if (!(b->BC == BCgoto || b->BC == BCiftrue) || b->Btry != head->Btry)
+        {
+            if (log) printf("\tBC not handled\n");
+            return false;
+        }
+
+        /* The only edge back to head must be from tail, no inner loops
+         */
+        for (list_t bl = b->Bsucc; bl; bl = list_next(bl))
+        {
+            block *bs = list_block(bl);
+            if (vec_testbit(bs->Bdfoidx, l->Lloop) && dom(bs, b) &&
+                !(bs == head && b == tail))
+            {
+                if (log) printf("\tinner loop\n");
+                return false;
+            }
+        }
+        if (b->Belem)
+            cost += el_length(b->Belem);
+        lb[n++] = b;
+    }
+    assert(n == numblocks);
+
+    elem *erel = unrollrel(tail->Belem);
+    if (!erel ||
+        erel->Eoper != OPlt ||
+        erel->E1->Eoper != OPvar ||
+        erel->E2->Eoper != OPconst ||
+        !tyintegral(erel->E1->Ety) ||
+        tysize(erel->E1->Ety) > sizeof(targ_llong))
+    {
+        if (log) printf("\tnot (v < c)\n");
+        return false;
+    }
+
+    Symbol* v = erel->E1->EV.sp.Vsym;
+    if (!(sytab[v->Sclass] & SCRD) || !(v->Sflags & SFLunambig))
+    {
+        if (log) printf("\tnot SCRD\n");
+        return false;
+    }
+
+    elem *einitial;
+    elem *eincrement;
+    extern bool findloopparameters(elem* erel, elem*& rdeq, elem*& rdinc);
+    if (!findloopparameters(erel, einitial, eincrement))
+    {
+        if (log) printf("\tnot findloopparameters()\n");
+        return false;
+    }
+
+    /* The increment must be done exactly once per iteration,
+     * so its block must dominate the tail.
+     */
+    for (i = 0; 1; i++)
+    {
+        if (i == n)
+        {
+            if (log) printf("\tincrement not in loop\n");
+            return false;
+        }
+        if (lb[i]->Belem && el_intree(lb[i]->Belem, eincrement))
+            break;
+    }
+    if (!dom(lb[i], tail))
+    {
+        if (log) printf("\tincrement does not dominate tail\n");
+        return false;
+    }
+
+    targ_llong initial = el_tolong(einitial->E2);
+    targ_llong increment = el_tolong(eincrement->E2);
+    if (eincrement->Eoper == OPpostdec || eincrement->Eoper == OPminass)
+        increment = -increment;
+    targ_llong final = el_tolong(erel->E2);
+
+    if (initial < 0 ||
+        final <= initial ||
+        increment <= 0 ||
+        (final - initial) % increment)
+    {
+        if (log) printf("\tnot (evenly divisible)\n");
+        return false;
+    }
+    targ_llong count = (final - initial) / increment;
+
+    // Pick the unroll factor
+    int factor;
+    for (factor = 8; factor > 1; factor >>= 1)
+    {
+        if (count % factor == 0 && factor * cost <= COSTMAX)
+            break;
+    }
+    if (factor == 1)
+    {
+        if (log) printf("\tno unroll factor for count %lld, cost %d\n", (long long)count, cost);
+        return false;
+    }
+    if (log) printf("Unrolling %d blocks by %d\n", n, factor);
+
+    // Blocks of each copy, copy 0 is the original loop
+    block **copy = (block **) mem_malloc(factor * n * sizeof(block *));
+    memcpy(copy, lb, n * sizeof(block *));
+    int ihead = -1;
+    int itail = -1;
+    for (i = 0; i < n; i++)
+    {
+        if (lb[i] == head)
+            ihead = i;
+        if (lb[i] == tail)
+            itail = i;
+    }
+    assert(ihead >= 0 && itail >= 0);
+
+    for (int j = 1; j < factor; j++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            block *b = lb[i];
+            block *bc = block_calloc();
+            numblks++;
+            bc->BC = b->BC;
+            bc->Belem = b->Belem ? el_copytree(b->Belem) : NULL;
+            bc->Btry = b->Btry;
+            bc->Bflags = b->Bflags;
+            bc->Bsrcpos = b->Bsrcpos;
+            bc->Bweight = b->Bweight;
+            copy[j * n + i] = bc;
+        }
+    }
+    maxblks += (factor - 1) * n;
+
+    // Connect the copies
+    block *bexit = list_block(list_next(tail->Bsucc));
+    for (int j = 1; j < factor; j++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            block *bc = copy[j * n + i];
+            for (list_t bl = lb[i]->Bsucc; bl; bl = list_next(bl))
+            {
+                block *bs = list_block(bl);
+                if (i == itail)
+                {
+                    if (j < factor - 1)
+                    {   // Tail goes on to the next copy
+                        if (bs == head)
+                            bs = copy[(j + 1) * n + ihead];
+                        else
+                            continue;
+                    }
+                }
+                else
+                {
+                    int k;
+                    for (k = 0; k < n && lb[k] != bs; k++)
+                        ;
+                    assert(k < n);
+                    bs = copy[j * n + k];
+                }
+                list_append(&bc->Bsucc, bs);
+                list_append(&bs->Bpred, bc);
+            }
+        }
+    }
+
+    // Original tail goes on to the first copy
+    list_subtract(&head->Bpred, tail);
+    list_subtract(&bexit->Bpred, tail);
+    list_free(&tail->Bsucc, FPNULL);
+    list_append(&tail->Bsucc, copy[n + ihead]);
+    list_append(&copy[n + ihead]->Bpred, tail);
+
+    /* All tails but the last one don't need the test
+     */
+    for (int j = 0; j < factor - 1; j++)
+    {
+        block *bt = copy[j * n + itail];
+        elem *e = unrollrel(bt->Belem);
+        elem *e2 = e->E2;
+        e->Eoper = OPcomma;
+        e2->EV.Vllong = 0;
+        e2->Ety = e->Ety;
+        bt->BC = BCgoto;
+    }
+
+    /* Append the copies after the last block of the loop
+     */
+    block *blast = NULL;
+    for (block *b = startblock; b; b = b->Bnext)
+    {
+        if (vec_testbit(b->Bdfoidx, l->Lloop))
+            blast = b;
+    }
+    for (int j = 1; j < factor; j++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            block *bc = copy[j * n + i];
+            bc->Bnext = blast->Bnext;
+            blast->Bnext = bc;
+            blast = bc;
+        }
+    }
+    mem_free(copy);
+
+    go.changes++;
+    return true;
+}
+
 /*********************************
  * Unroll loop if possible.
  * Params:
@@ -3504,13 +4117,16 @@ static bool loopunroll(loop *l)
         return false;
     l->Lhead->Bflags |= BFLnounroll;
 
-    /* For simplification, only unroll loops that consist only
-     * of a head and tail, and the tail is the exit block.
+    /* Loops of more than two blocks are left to loopunrollblocks().
+     * Here, only unroll loops that consist only of a head and tail,
+     * and the tail is the exit block.
      */
     int numblocks = 0;
     int i;
     foreach (i,dfotop,l->Lloop)
         ++numblocks;
+    if (numblocks > 2)
+        return loopunrollblocks(l, numblocks);
     if (numblocks != 2)
     {
         if (log) printf("\tnot 2 blocks\n");
@@ -15,7 +15,7 @@
 #include        <stdio.h>
 #include        <string.h>
 #include        <stdlib.h>
-#include        <time.h>
+#include        <ctype.h>
 
 #include        "cc.h"
 #include        "global.h"
@@ -23,6 +23,7 @@
 #include        "el.h"
 #include        "go.h"
 #include        "type.h"
+#include        "obj.h"
 
 static char __file__[] = __FILE__;      /* for tassert.h                */
 #include        "tassert.h"
@@ -33,6 +34,9 @@ static char __file__[] = __FILE__;      /* for tassert.h                */
 
 void go_term()
 {
+#if !HTOD
+    profile_term();
+#endif
     vec_free(go.defkill);
     vec_free(go.starkill);
     vec_free(go.vptrkill);
@@ -71,15 +75,15 @@ int go_flag(char *cp)
     enum GL     // indices of various flags in flagtab[]
     {
         GLO,GLall,GLcnp,GLcp,GLcse,GLda,GLdc,GLdv,GLli,GLliv,GLlocal,GLloop,
-        GLnone,GLo,GLreg,GLspace,GLspeed,GLtime,GLtree,GLvbe,GLMAX
+        GLnone,GLo,GLreg,GLscan,GLspace,GLspeed,GLtime,GLtree,GLvbe,GLvec,GLMAX
     };
     static const char *flagtab[] =
     {   "O","all","cnp","cp","cse","da","dc","dv","li","liv","local","loop",
-        "none","o","reg","space","speed","time","tree","vbe"
+        "none","o","reg","scan","space","speed","time","tree","vbe","vec"
     };
     static mftype flagmftab[] =
     {   0,MFall,MFcnp,MFcp,MFcse,MFda,MFdc,MFdv,MFli,MFliv,MFlocal,MFloop,
-        0,0,MFreg,0,MFtime,MFtime,MFtree,MFvbe
+        0,0,MFreg,MFscan,0,MFtime,MFtime,MFtree,MFvbe,MFvec
     };
 
     i = GLMAX;
@@ -87,6 +91,35 @@ int go_flag(char *cp)
     assert(i == arraysize(flagmftab));
 
     //printf("go_flag('%s')\n", cp);
+    if (strncmp(cp + 1, "budget", 6) == 0)
+    {
+        // +budget=n    limit optimizer work per function to n units, n > 0
+        // -budget      no limit
+        if (*cp == '-' && !cp[7])
+            go.budget = ~0UL;
+        else if (*cp == '+' && cp[7] == '=' && isdigit(cp[8]))
+        {   char *p;
+            unsigned long n = strtoul(cp + 8, &p, 10);
+            if (*p || n == 0)           // 0 is reserved for the default
+                goto badflag;
+            go.budget = n;
+        }
+        else
+            goto badflag;
+        return 1;
+    }
+    if (strncmp(cp + 1, "profile", 7) == 0)
+    {
+        // +profile=file    read call counts from trace.log written by -gt
+        // -profile         no profile
+        if (*cp == '-' && !cp[8])
+            go.profname = NULL;
+        else if (*cp == '+' && cp[8] == '=' && cp[9])
+            go.profname = cp + 9;
+        else
+            goto badflag;
+        return 1;
+    }
     flag = binary(cp + 1,flagtab,GLMAX);
     if (go.mfoptim == 0 && flag != -1)
         go.mfoptim = MFall & ~MFvbe;
@@ -96,6 +129,8 @@ int go_flag(char *cp)
         switch (flag)
         {
             case GLall:
+                go.mfoptim &= ~(MFall | MFscan | MFvec);   // same as +none
+                break;
             case GLcnp:
             case GLcp:
             case GLdc:
@@ -107,10 +142,12 @@ int go_flag(char *cp)
             case GLlocal:
             case GLloop:
             case GLreg:
+            case GLscan:
             case GLspeed:
             case GLtime:
             case GLtree:
             case GLvbe:
+            case GLvec:
                 go.mfoptim &= ~flagmftab[flag];    /* clear bits   */
                 break;
             case GLo:
@@ -143,14 +180,16 @@ int go_flag(char *cp)
             case GLlocal:
             case GLloop:
             case GLreg:
+            case GLscan:
             case GLspeed:
             case GLtime:
             case GLtree:
             case GLvbe:
+            case GLvec:
                 go.mfoptim |= flagmftab[flag];     /* set bits     */
                 break;
             case GLnone:
-                go.mfoptim &= ~MFall;      /* inverse of +all      */
+                go.mfoptim &= ~(MFall | MFscan | MFvec);   // inverse of +all
                 break;
             case GLspace:
                 go.mfoptim &= ~MFtime;     /* inverse of +time     */
@@ -189,6 +228,393 @@ void dbg_optprint(char *title)
 }
 #endif
 
+#if !HTOD
+
+static unsigned long nelems;    // number of elems in the function
+
+STATIC unsigned long countelems(elem *e)
+{
+    unsigned long n = 1;
+    while (1)
+    {
+        if (EBIN(e))
+        {   n += countelems(e->E2) + 1;
+            e = e->E1;
+        }
+        else if (EUNA(e))
+        {   n++;
+            e = e->E1;
+        }
+        else
+            break;
+    }
+    return n;
+}
+
+/****************************
+ * Run optimizer pass, charging its work against the budget.
+ * Every pass visits each elem at least once, data flow solvers
+ * also add the bit vector words they process to go.work.
+ */
+
+STATIC void runpass(GP pass, void (*fp)())
+{
+    unsigned long work = go.work;
+    go.work += nelems;
+    (*fp)();
+    go.passwork[pass] += go.work - work;
+}
+
+/****************************
+ * Returns:
+ *      true if there is budget left for another optimization iteration
+ */
+
+STATIC bool withinbudget()
+{
+    unsigned long budget = go.budget ? go.budget : GObudget;
+    return go.work < budget;
+}
+
+STATIC void blockopt0() { blockopt(0); }
+
+/**********************************************
+ * Profile read from the trace.log written by a program compiled with -gt
+ * (see trace.c). For each function it gives the number of times it was
+ * called, and how many times it called each of the functions it called.
+ */
+
+struct ProfFunc;
+
+struct ProfCall
+{
+    ProfCall *next;
+    char *name;                 // function called
+    ProfFunc *func;             // and its entry, NULL if not profiled
+    unsigned count;             // number of calls
+};
+
+struct ProfFunc
+{
+    char *name;                 // name as written by trace.c
+    unsigned count;             // number of times called
+    ProfCall *fanout;           // functions called by this one
+    unsigned sites;             // call sites to this function in funcsym_p
+};
+
+static ProfFunc *proffuncs;     // sorted by name
+static unsigned nproffuncs;
+static bool profloaded;
+static bool profcovered;        // a function only this module defines is in the profile
+
+#ifndef __DMC__
+#undef __cdecl
+#define __cdecl
+#endif
+
+static int __cdecl proffunc_cmp(const void *p1,const void *p2)
+{
+    return strcmp(((const ProfFunc *)p1)->name, ((const ProfFunc *)p2)->name);
+}
+
+STATIC ProfFunc *profile_search(const char *name)
+{
+    ProfFunc key;
+    key.name = (char *)name;
+    return (ProfFunc *)bsearch(&key, proffuncs, nproffuncs, sizeof(ProfFunc), &proffunc_cmp);
+}
+
+/*********************************
+ * Read go.profname the first time the profile is needed.
+ * Only the call graph part of trace.log is used, the timings that
+ * follow the "====" line are ignored.
+ */
+
+STATIC void profile_load()
+{
+    if (profloaded || !go.profname)
+        return;
+    profloaded = true;
+
+    FILE *fp = fopen(go.profname, "r");
+    if (!fp)
+        err_fatal(EM_open_input, go.profname);      // open failure
+
+    static char buf[IDMAX + IDOHD + 100];
+    unsigned maxfuncs = 0;
+    ProfFunc *pf = NULL;                // function whose fan out is being read
+    while (fgets(buf, sizeof(buf), fp))
+    {
+        char *p = buf;
+        size_t len = strlen(p);
+        if (len && p[len - 1] != '\n' && !feof(fp))
+        {   // Name too long to be one prolog_trace() generates, skip line
+            int c;
+            while ((c = fgetc(fp)) != EOF && c != '\n')
+                ;
+            continue;
+        }
+        switch (*p)
+        {
+            case '=':                   // start of the timings
+                goto Ldone;
+
+            case ' ':
+            case '\t':                  // fan in or fan out line
+            {
+                unsigned count = strtoul(p, &p, 10);
+                while (isspace(*p))
+                    p++;
+                if (!pf || !isgraph(*p))
+                    break;              // fan in lines are not used
+                char *q = p;
+                while (isgraph(*q))
+                    q++;
+                *q = 0;
+                ProfCall *pc = (ProfCall *)mem_malloc(sizeof(ProfCall));
+                pc->next = pf->fanout;
+                pc->name = mem_strdup(p);
+                pc->func = NULL;
+                pc->count = count;
+                pf->fanout = pc;
+                break;
+            }
+
+            default:
+                if (!isgraph(*p) || *p == '-')
+                {   pf = NULL;          // separator between functions
+                    break;
+                }
+                char *q = p;
+                while (isgraph(*q))
+                    q++;
+                *q++ = 0;
+                if (nproffuncs == maxfuncs)
+                {
+                    maxfuncs = 2 * maxfuncs + 16;
+                    proffuncs = (ProfFunc *)util_realloc(proffuncs, maxfuncs, sizeof(ProfFunc));
+                }
+                pf = &proffuncs[nproffuncs++];
+                pf->name = mem_strdup(p);
+                pf->count = strtoul(q, NULL, 10);
+                pf->fanout = NULL;
+                pf->sites = 0;
+                break;
+        }
+    }
+Ldone:
+    fclose(fp);
+
+    qsort(proffuncs, nproffuncs, sizeof(ProfFunc), &proffunc_cmp);
+    for (unsigned i = 0; i < nproffuncs; i++)
+        for (ProfCall *pc = proffuncs[i].fanout; pc; pc = pc->next)
+            pc->func = profile_search(pc->name);
+}
+
+void profile_term()
+{
+    for (unsigned i = 0; i < nproffuncs; i++)
+    {
+        ProfCall *pcnext;
+        for (ProfCall *pc = proffuncs[i].fanout; pc; pc = pcnext)
+        {   pcnext = pc->next;
+            mem_free(pc->name);
+            mem_free(pc);
+        }
+        mem_free(proffuncs[i].name);
+    }
+    util_free(proffuncs);
+    proffuncs = NULL;
+    nproffuncs = 0;
+    profloaded = false;
+    profcovered = false;
+}
+
+/*********************************
+ * Find profile entry for function s, using the same name
+ * prolog_trace() passes to trace.c.
+ */
+
+STATIC ProfFunc *profile_func(Symbol *s)
+{
+    profile_load();
+    if (!nproffuncs)
+        return NULL;
+#if ELFOBJ || MACHOBJ
+    return profile_search(s->Sident);
+#else
+    char name[IDMAX + IDOHD + 1];
+    size_t len = objmod->mangle(s,name);
+    assert(len < sizeof(name));
+    name[len] = 0;
+    // skip length prefix
+    return profile_search(name[0] == (char)0xFF && name[1] == 0 ? name + 4 : name + 1);
+#endif
+}
+
+/*********************************
+ * Returns:
+ *      number of times function s was called in the profiling run,
+ *      0 if not known
+ */
+
+unsigned profile_count(Symbol *s)
+{
+    ProfFunc *pf = profile_func(s);
+    return pf ? pf->count : 0;
+}
+
+/*********************************
+ * Functions are only known to be cold if the profiling run covered this
+ * module, or else every function added since the run, or compiled
+ * without -gt, or whose name doesn't match would be cold as well.
+ * Take the module as covered once one of the functions compiled so far
+ * that only it defines (not a COMDAT, which any module might supply)
+ * is in the profile.
+ * Returns:
+ *      true if there is a profile covering this module and function s
+ *      was never called
+ */
+
+bool profile_cold(Symbol *s)
+{
+    profile_load();
+    if (!nproffuncs)
+        return false;
+    ProfFunc *pf = profile_func(s);
+    if (pf && !symbol_iscomdat(s))
+        profcovered = true;
+    return profcovered && (!pf || pf->count == 0);
+}
+
+/*********************************
+ * Returns:
+ *      true if scaller ran in the profiling run but never called scallee,
+ *      even though scallee itself was profiled
+ */
+
+bool profile_coldcall(Symbol *scaller, Symbol *scallee)
+{
+    ProfFunc *pcaller = profile_func(scaller);
+    if (!pcaller || !pcaller->count)
+        return false;
+    ProfFunc *pcallee = profile_func(scallee);
+    if (!pcallee)
+        return false;
+    for (ProfCall *pc = pcaller->fanout; pc; pc = pc->next)
+    {
+        if (pc->func == pcallee)
+            return false;
+    }
+    return true;
+}
+
+/*********************************
+ * Walk e looking for direct calls to profiled functions.
+ * Count the call sites if pweight is NULL, otherwise set *pweight to the
+ * largest number of times per call of pf one of those calls was executed.
+ * cond is true if e is only conditionally evaluated.
+ * Returns:
+ *      true if a call was found that determines the weight of the block,
+ *      calls that did not happen count only if they are not conditional
+ */
+
+STATIC bool profile_walk(elem *e, ProfFunc *pf, unsigned *pweight, bool cond)
+{
+    bool found = false;
+    while (1)
+    {
+        elem_debug(e);
+        if (OTcall(e->Eoper) && e->E1->Eoper == OPvar)
+        {
+            ProfFunc *pg = profile_func(e->E1->EV.sp.Vsym);
+            if (pg)
+            {
+                if (!pweight)
+                    pg->sites++;
+                else
+                {
+                    /* The fan out count is for all call sites of pg,
+                     * assume they share it evenly.
+                     */
+                    unsigned long long calls = 0;
+                    for (ProfCall *pc = pf->fanout; pc; pc = pc->next)
+                    {
+                        if (pc->func == pg)
+                            calls += pc->count;
+                    }
+                    unsigned long long n = (unsigned long long)pf->count * (pg->sites ? pg->sites : 1);
+                    unsigned long long w = (calls + n - 1) / n;
+                    if (w > 0x10000)            // same limit as loop weights
+                        w = 0x10000;
+                    if (w > *pweight)
+                        *pweight = w;
+                    if (w || !cond)
+                        found = true;
+                }
+            }
+        }
+        if (OTbinary(e->Eoper))
+        {
+            const unsigned op = e->Eoper;
+            const bool colon = op == OPcolon || op == OPcolon2;
+            found |= profile_walk(e->E2, pf, pweight,
+                                  cond || colon || op == OPandand || op == OPoror);
+            cond |= colon;
+            e = e->E1;
+        }
+        else if (OTunary(e->Eoper))
+            e = e->E1;
+        else
+            break;
+    }
+    return found;
+}
+
+/*********************************
+ * Replace the loop nesting estimate of Bweight with the profile for the
+ * blocks of funcsym_p that make calls. The number of times the block ran
+ * per call of funcsym_p is rounded up to a power of 10, which is what
+ * loop_weight() would give a block nested that many loops deep, so these
+ * blocks compare sensibly with the ones that keep the estimate.
+ * A block whose calls never happened gets a Bweight of 0 and is marked
+ * BFLcold.
+ */
+
+STATIC void profile_weights()
+{
+    ProfFunc *pf = profile_func(funcsym_p);
+    if (!pf || !pf->count)
+        return;
+
+    for (unsigned i = 0; i < nproffuncs; i++)
+        proffuncs[i].sites = 0;
+    for (block *b = startblock; b; b = b->Bnext)
+    {
+        if (b->Belem)
+            profile_walk(b->Belem, pf, NULL, false);
+    }
+    for (block *b = startblock; b; b = b->Bnext)
+    {
+        unsigned weight = 0;
+        if (b->Belem && profile_walk(b->Belem, pf, &weight, false))
+        {
+            if (!weight)
+            {   b->Bweight = 0;
+                b->Bflags |= BFLcold;
+            }
+            else
+            {   unsigned w = 1;
+                while (w < weight)      // weight is at most 0x10000
+                    w *= 10;
+                b->Bweight = w;
+            }
+        }
+    }
+}
+
+#endif
+
 /****************************
  * Optimize function.
  */
@@ -198,7 +624,6 @@ void optfunc()
 #if !HTOD
     block *b;
     int iter;           // iteration count
-    clock_t starttime;
 
     cmes ("optfunc()\n");
     dbg_optprint("optfunc\n");
@@ -234,8 +659,10 @@ void optfunc()
     }
 
     // Some functions can take enormous amounts of time to optimize.
-    // We try to put a lid on it.
-    starttime = clock();
+    // We try to put a lid on it, measured in work done rather than
+    // elapsed time so the generated code does not depend on machine load.
+    go.work = 0;
+    memset(go.passwork, 0, sizeof(go.passwork));
     do
     {
         //printf("iter = %d\n", iter);
@@ -249,8 +676,15 @@ void optfunc()
         file_progress();
 #endif
 
+        nelems = 0;
+        for (b = startblock; b; b = b->Bnext)
+            if (b->Belem)
+                nelems += countelems(b->Belem);
+
         //printf("optelem\n");
         /* canonicalize the trees        */
+        go.work += nelems;
+        go.passwork[GPoptelem] += nelems;
         for (b = startblock; b; b = b->Bnext)
             if (b->Belem)
             {
@@ -273,16 +707,16 @@ void optfunc()
             }
         //printf("blockopt\n");
         if (go.mfoptim & MFdc)
-            blockopt(0);                // do block optimization
+            runpass(GPblockopt, &blockopt0);    // do block optimization
         out_regcand(&globsym);          // recompute register candidates
         go.changes = 0;                 // no changes yet
         sliceStructs();
         if (go.mfoptim & MFcnp)
-            constprop();                /* make relationals unsigned     */
+            runpass(GPconstprop, &constprop);   /* make relationals unsigned     */
         if (go.mfoptim & (MFli | MFliv))
-            loopopt();                  /* remove loop invariants and    */
-                                        /* induction vars                */
-                                        /* do loop rotation              */
+            runpass(GPloopopt, &loopopt);       /* remove loop invariants and    */
+                                                /* induction vars                */
+                                                /* do loop rotation              */
         else
             for (b = startblock; b; b = b->Bnext)
                 b->Bweight = 1;
@@ -290,13 +724,16 @@ void optfunc()
 
         if (go.mfoptim & MFcnp)
             boolopt();                  // optimize boolean values
-        if (go.changes && go.mfoptim & MFloop && (clock() - starttime) < 30 * CLOCKS_PER_SEC)
+        if (go.changes && go.mfoptim & MFloop && withinbudget())
             continue;
 
-        if (go.mfoptim & MFcnp)
-            constprop();                /* constant propagation          */
+        /* If nothing changed since the constprop() above, the reaching
+         * definitions would come out the same and it would find nothing new.
+         */
+        if (go.mfoptim & MFcnp && go.changes)
+            runpass(GPconstprop, &constprop);   /* constant propagation          */
         if (go.mfoptim & MFcp)
-            copyprop();                 /* do copy propagation           */
+            runpass(GPcopyprop, &copyprop);     /* do copy propagation           */
 
         /* Floating point constants and string literals need to be
          * replaced with loads from variables in read-only data.
@@ -327,15 +764,28 @@ void optfunc()
          * code generation which assumes at most one (localgotoffset).
          */
         if (go.mfoptim & MFlocal)
-            localize();                 // improve expression locality
+            runpass(GPlocalize, &localize);     // improve expression locality
         if (go.mfoptim & MFda)
-            rmdeadass();                /* remove dead assignments       */
+            runpass(GPrmdeadass, &rmdeadass);   /* remove dead assignments       */
 
         cmes2 ("changes = %d\n", go.changes);
-        if (!(go.changes && go.mfoptim & MFloop && (clock() - starttime) < 30 * CLOCKS_PER_SEC))
+        if (!(go.changes && go.mfoptim & MFloop && withinbudget()))
             break;
     } while (1);
     cmes2("%d iterations\n",iter);
+    if (configv.verbose == 2)
+    {
+        static const char *passnames[GPMAX] =
+        {   "optelem","blockopt","constprop","copyprop","loopopt","localize","rmdeadass"
+        };
+        printf("optfunc %s: %d iterations, work %lu%s\n", funcsym_p->Sident, iter, go.work,
+            withinbudget() ? "" : " (budget exhausted)");
+        for (int i = 0; i < GPMAX; i++)
+            if (go.passwork[i])
+                printf("\t%-10s %lu\n", passnames[i], go.passwork[i]);
+    }
+    if (go.profname)
+        profile_weights();              // before blockopt() rearranges blocks
     if (go.mfoptim & MFdc)
         blockopt(1);                    // do block optimization
 
@@ -39,8 +39,32 @@ enum
     MFtree  = 0x1000,          // optelem (tree optimization)
     MFlocal = 0x2000,          // localize expressions
     MFall   = 0xFFFF,          // do everything
+    MFscan  = 0x10000,         // linear scan register assignment (not part of MFall)
+    MFvec   = 0x20000,         // loop vectorization (not part of MFall)
 };
 
+/***************************************
+ * Optimizer passes whose work is accounted for separately.
+ */
+
+enum GP
+{
+    GPoptelem,          // tree optimization (optelem)
+    GPblockopt,         // block optimization
+    GPconstprop,        // constant propagation
+    GPcopyprop,         // copy propagation
+    GPloopopt,          // loop invariants and induction variables
+    GPlocalize,         // expression localization
+    GPrmdeadass,        // dead assignment elimination
+    GPMAX
+};
+
+/* Optimization work is measured in units of one elem visited or one bit
+ * vector word processed by a data flow solver, so how much optimization
+ * a function gets depends only on the function, not on machine speed.
+ */
+#define GObudget        400000000       // default work allowed per function
+
 /**********************************
  * Definition elem vector, used for reaching definitions.
  */
@@ -78,6 +102,12 @@ struct GlobalOptimizer
     vec_t starkill;     // vector of AEs killed by a definition of something that somebody could be
                         // pointing to
     vec_t vptrkill;     // vector of AEs killed by an access
+
+    unsigned long budget;       // work allowed per function, 0 means GObudget
+    unsigned long work;         // work done so far on the current function
+    unsigned long passwork[GPMAX];      // work done by each pass on the current function
+
+    const char *profname;       // trace.log to read profile from, NULL if none
 };
 
 extern GlobalOptimizer go;
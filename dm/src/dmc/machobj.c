@@ -147,9 +147,11 @@ struct Comdef { symbol *sym; targ_size_t size; int count; };
 static Outbuffer *comdef_symbuf;        // Comdef's are stored here
 
 static Outbuffer *indirectsymbuf1;      // indirect symbol table of Symbol*'s
+static AArray *indirectsymtab1;         // Symbol* => 1 + index into indirectsymbuf1
 static int jumpTableSeg;                // segment index for __jump_table
 
 static Outbuffer *indirectsymbuf2;      // indirect symbol table of Symbol*'s
+static AArray *indirectsymtab2;         // Symbol* => 1 + index into indirectsymbuf2
 static int pointersSeg;                 // segment index for __pointers
 
 /* If an Obj::external_def() happens, set this to the string index,
@@ -273,67 +275,6 @@ IDXSTR Obj::addstr(Outbuffer *strtab, const char *str)
     return idx;
 }
 
-/*******************************
- * Find a string in a string table
- * Input:
- *      strtab  =       string table for entry
- *      str     =       string to find
- *
- * Returns index into the specified string table or 0.
- */
-
-static IDXSTR elf_findstr(Outbuffer *strtab, const char *str, const char *suffix)
-{
-    const char *ent = (char *)strtab->buf+1;
-    const char *pend = ent+strtab->size() - 1;
-    const char *s = str;
-    const char *sx = suffix;
-    int len = strlen(str);
-
-    if (suffix)
-        len += strlen(suffix);
-
-    while(ent < pend)
-    {
-        if(*ent == 0)                   // end of table entry
-        {
-            if(*s == 0 && !sx)          // end of string - found a match
-            {
-                return ent - (const char *)strtab->buf - len;
-            }
-            else                        // table entry too short
-            {
-                s = str;                // back to beginning of string
-                sx = suffix;
-                ent++;                  // start of next table entry
-            }
-        }
-        else if (*s == 0 && sx && *sx == *ent)
-        {                               // matched first string
-            s = sx+1;                   // switch to suffix
-            ent++;
-            sx = NULL;
-        }
-        else                            // continue comparing
-        {
-            if (*ent == *s)
-            {                           // Have a match going
-                ent++;
-                s++;
-            }
-            else                        // no match
-            {
-                while(*ent != 0)        // skip to end of entry
-                    ent++;
-                ent++;                  // start of next table entry
-                s = str;                // back to beginning of string
-                sx = suffix;
-            }
-        }
-    }
-    return 0;                   // never found match
-}
-
 /*******************************
  * Output a mangled string into the symbol string table
  * Input:
@@ -525,10 +466,16 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
 
     if (indirectsymbuf1)
         indirectsymbuf1->setsize(0);
+    if (indirectsymtab1)
+        delete indirectsymtab1;
+    indirectsymtab1 = new AArray(&ti_pvoid, sizeof(int));
     jumpTableSeg = 0;
 
     if (indirectsymbuf2)
         indirectsymbuf2->setsize(0);
+    if (indirectsymtab2)
+        delete indirectsymtab2;
+    indirectsymtab2 = new AArray(&ti_pvoid, sizeof(int));
     pointersSeg = 0;
 
     // Initialize segments for CODE, DATA, UDATA and CDATA
@@ -1855,6 +1802,15 @@ int Obj::jmpTableSegment(Symbol *s)
     return (config.flags & CFGromable) ? cseg : CDATA;
 }
 
+/***********************************
+ * Returns:
+ *      segment for code unlikely to be executed
+ */
+int Obj::coldcodeseg()
+{
+    return CODE;
+}
+
 /**********************************
  * Get segment.
  * Input:
@@ -2679,18 +2635,14 @@ int Obj::reftoident(int seg, targ_size_t offset, Symbol *s, targ_size_t val,
 
                 if (!indirectsymbuf1)
                     indirectsymbuf1 = new Outbuffer();
-                else
-                {   // Look through indirectsym to see if it is already there
-                    int n = indirectsymbuf1->size() / sizeof(Symbol *);
-                    Symbol **psym = (Symbol **)indirectsymbuf1->buf;
-                    for (int i = 0; i < n; i++)
-                    {   // Linear search, pretty pathetic
-                        if (s == psym[i])
-                        {   val = i * 5;
-                            goto L1;
-                        }
-                    }
+
+                // See if s is already in indirectsymbuf1
+                int *pi = (int *)indirectsymtab1->get(&s);
+                if (*pi)
+                {   val = (*pi - 1) * 5;
+                    goto L1;
                 }
+                *pi = 1 + indirectsymbuf1->size() / sizeof(Symbol *);
 
                 val = pseg->SDbuf->size();
                 static char halts[5] = { 0xF4,0xF4,0xF4,0xF4,0xF4 };
@@ -2721,18 +2673,14 @@ int Obj::reftoident(int seg, targ_size_t offset, Symbol *s, targ_size_t val,
 
                 if (!indirectsymbuf2)
                     indirectsymbuf2 = new Outbuffer();
-                else
-                {   // Look through indirectsym to see if it is already there
-                    int n = indirectsymbuf2->size() / sizeof(Symbol *);
-                    Symbol **psym = (Symbol **)indirectsymbuf2->buf;
-                    for (int i = 0; i < n; i++)
-                    {   // Linear search, pretty pathetic
-                        if (s == psym[i])
-                        {   val = i * 4;
-                            goto L2;
-                        }
-                    }
+
+                // See if s is already in indirectsymbuf2
+                int *pi = (int *)indirectsymtab2->get(&s);
+                if (*pi)
+                {   val = (*pi - 1) * 4;
+                    goto L2;
                 }
+                *pi = 1 + indirectsymbuf2->size() / sizeof(Symbol *);
 
                 val = pseg->SDbuf->size();
                 pseg->SDbuf->writezeros(NPTRSIZE);
@@ -87,6 +87,7 @@ static segidx_t segidx_pdata = UNKNOWN;
 static int jumpTableSeg;                // segment index for __jump_table
 
 static Outbuffer *indirectsymbuf2;      // indirect symbol table of Symbol*'s
+static AArray *indirectsymtab2;         // Symbol* => 1 + index into indirectsymbuf2
 static int pointersSeg;                 // segment index for __pointers
 
 static Outbuffer *ptrref_buf;           // buffer for pointer references
@@ -167,67 +168,6 @@ IDXSTR MsCoffObj::addstr(Outbuffer *strtab, const char *str)
     return idx;
 }
 
-/*******************************
- * Find a string in a string table
- * Input:
- *      strtab  =       string table for entry
- *      str     =       string to find
- *
- * Returns index into the specified string table or 0.
- */
-
-static IDXSTR elf_findstr(Outbuffer *strtab, const char *str, const char *suffix)
-{
-    const char *ent = (char *)strtab->buf+4;
-    const char *pend = ent+strtab->size() - 1;
-    const char *s = str;
-    const char *sx = suffix;
-    int len = strlen(str);
-
-    if (suffix)
-        len += strlen(suffix);
-
-    while(ent < pend)
-    {
-        if(*ent == 0)                   // end of table entry
-        {
-            if(*s == 0 && !sx)          // end of string - found a match
-            {
-                return ent - (const char *)strtab->buf - len;
-            }
-            else                        // table entry too short
-            {
-                s = str;                // back to beginning of string
-                sx = suffix;
-                ent++;                  // start of next table entry
-            }
-        }
-        else if (*s == 0 && sx && *sx == *ent)
-        {                               // matched first string
-            s = sx+1;                   // switch to suffix
-            ent++;
-            sx = NULL;
-        }
-        else                            // continue comparing
-        {
-            if (*ent == *s)
-            {                           // Have a match going
-                ent++;
-                s++;
-            }
-            else                        // no match
-            {
-                while(*ent != 0)        // skip to end of entry
-                    ent++;
-                ent++;                  // start of next table entry
-                s = str;                // back to beginning of string
-                sx = suffix;
-            }
-        }
-    }
-    return 0;                   // never found match
-}
-
 /*******************************
  * Output a mangled string into the symbol string table
  * Input:
@@ -1413,6 +1353,19 @@ int MsCoffObj::jmpTableSegment(Symbol *s)
     return (config.flags & CFGromable) ? cseg : DATA;
 }
 
+/***********************************
+ * Returns:
+ *      segment for code unlikely to be executed;
+ *      the linker sorts .text$x after the rest of .text
+ */
+int MsCoffObj::coldcodeseg()
+{
+    return MsCoffObj::getsegment(".text$x", IMAGE_SCN_CNT_CODE |
+                                    (I64 ? IMAGE_SCN_ALIGN_16BYTES : IMAGE_SCN_ALIGN_4BYTES) |
+                                    IMAGE_SCN_MEM_EXECUTE |
+                                    IMAGE_SCN_MEM_READ);
+}
+
 
 /**********************************
  * Get segment, which may already exist.
@@ -2327,19 +2280,17 @@ int MsCoffObj::reftoident(segidx_t seg, targ_size_t offset, Symbol *s, targ_size
                 seg_data *pseg = SegData[pointersSeg];
 
                 if (!indirectsymbuf2)
-                    indirectsymbuf2 = new Outbuffer();
-                else
-                {   // Look through indirectsym to see if it is already there
-                    int n = indirectsymbuf2->size() / sizeof(Symbol *);
-                    Symbol **psym = (Symbol **)indirectsymbuf2->buf;
-                    for (int i = 0; i < n; i++)
-                    {   // Linear search, pretty pathetic
-                        if (s == psym[i])
-                        {   val = i * 4;
-                            goto L2;
-                        }
-                    }
+                {   indirectsymbuf2 = new Outbuffer();
+                    indirectsymtab2 = new AArray(&ti_pvoid, sizeof(int));
+                }
+
+                // See if s is already in indirectsymbuf2
+                int *pi = (int *)indirectsymtab2->get(&s);
+                if (*pi)
+                {   val = (*pi - 1) * 4;
+                    goto L2;
                 }
+                *pi = 1 + indirectsymbuf2->size() / sizeof(Symbol *);
 
                 val = pseg->SDbuf->size();
                 pseg->SDbuf->writezeros(NPTRSIZE);
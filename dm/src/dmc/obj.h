@@ -102,6 +102,7 @@ struct seg_data;
         static void func_term(Symbol *sfunc);
         static void write_pointerRef(Symbol* s, unsigned off);
         static int jmpTableSegment(Symbol* s);
+        static int coldcodeseg();
 
         static symbol *tlv_bootstrap();
 
@@ -188,6 +189,7 @@ class Obj
     VIRTUAL void func_term(Symbol *sfunc);
     VIRTUAL void write_pointerRef(Symbol* s, unsigned off);
     VIRTUAL int jmpTableSegment(Symbol* s);
+    VIRTUAL int coldcodeseg();
 
     VIRTUAL symbol *tlv_bootstrap();
 
@@ -300,6 +302,7 @@ class MsCoffObj : public Obj
     VIRTUAL void func_term(Symbol *sfunc);
     VIRTUAL void write_pointerRef(Symbol* s, unsigned off);
     VIRTUAL int jmpTableSegment(Symbol* s);
+    VIRTUAL int coldcodeseg();
 
     static int getsegment(const char *sectname, unsigned long flags);
     static int getsegment2(unsigned shtidx);
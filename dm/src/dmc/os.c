@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/mman.h>
 #define GetLastError() errno
 #elif _WIN32
 #include <dos.h>
@@ -608,6 +609,184 @@ unsigned os_unique()
 
 #endif
 
+#if __linux__ || __APPLE__ || __FreeBSD__ || __OpenBSD__ || __sun
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS   MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE   0
+#endif
+
+/*****************************************
+ * Functions to manage allocating a single virtual address space.
+ * Same semantics as the Win32 versions: reserved memory is inaccessible
+ * until committed, and if ptr is given the range must start there.
+ */
+
+void *vmem_reserve(void *ptr,unsigned size)
+{   void *p;
+
+    p = mmap(ptr,size,PROT_NONE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,-1,0);
+    if (p == MAP_FAILED)
+        p = NULL;
+    else if (ptr && p != ptr)
+    {   // Got some other address range, which is no use to the caller
+        munmap(p,size);
+        p = NULL;
+    }
+    dbg_printf("vmem_reserve(ptr = %p, size = x%lx) = %p\n",ptr,size,p);
+    return p;
+}
+
+/*****************************************
+ * Commit memory.
+ * Returns:
+ *      0       failure
+ *      !=0     success
+ */
+
+int vmem_commit(void *ptr, unsigned size)
+{
+    dbg_printf("vmem_commit(ptr = %p,size = x%lx)\n",ptr,size);
+    if (mprotect(ptr,size,PROT_READ | PROT_WRITE) == 0)
+        return 1;
+    dbg_printf("failed to commit\n");
+    return 0;
+}
+
+void vmem_decommit(void *ptr,unsigned size)
+{
+    dbg_printf("vmem_decommit(ptr = %p, size = x%lx)\n",ptr,size);
+    if (ptr)
+    {   if (madvise(ptr,size,MADV_DONTNEED) || mprotect(ptr,size,PROT_NONE))
+            os_error();
+    }
+}
+
+void vmem_release(void *ptr,unsigned size)
+{
+    dbg_printf("vmem_release(ptr = %p, size = x%lx)\n",ptr,size);
+    if (ptr)
+    {
+        if (munmap(ptr,size))
+            os_error();
+    }
+}
+
+/********************************************
+ * Map file for read, copy on write, into virtual address space.
+ * Unlike Win32, if the range at ptr is in use the file is mapped
+ * wherever the system puts it; precompiled headers are hydrated
+ * relative to where they actually land.
+ * Input:
+ *      ptr             address to map file to, if NULL then pick an address
+ *      size            length of the file
+ *      flag    0       read / write
+ *              1       read / copy on write
+ *              2       read only
+ * Returns:
+ *      NULL    failure
+ *      ptr     pointer to start of mapped file
+ */
+
+static int hFile = -1;
+static void *pview;
+static size_t pview_size;
+
+void *vmem_mapfile(const char *filename,void *ptr,unsigned size,int flag)
+{
+    dbg_printf("vmem_mapfile(filename = '%s', ptr = %p, size = x%lx, flag = %d)\n",filename,ptr,size,flag);
+
+    hFile = open(filename, (flag == 2) ? O_RDONLY : O_RDWR);
+    if (hFile == -1)
+        return NULL;                    // failure
+
+    pview = mmap(ptr,size,
+            (flag == 2) ? PROT_READ : PROT_READ | PROT_WRITE,
+            (flag == 0) ? MAP_SHARED : MAP_PRIVATE,
+            hFile,0);
+    if (pview == MAP_FAILED)
+    {   pview = NULL;
+        close(hFile);
+        hFile = -1;
+        return NULL;                    // failure
+    }
+    pview_size = size;
+    dbg_printf(" pview = %p\n",pview);
+    return pview;
+}
+
+/*****************************
+ * Set size of mapped file.
+ */
+
+void vmem_setfilesize(unsigned size)
+{
+    if (hFile != -1)
+    {   if (ftruncate(hFile,size))
+            os_error();
+    }
+}
+
+/*****************************
+ * Unmap previous file mapping.
+ */
+
+void vmem_unmapfile()
+{
+    dbg_printf("vmem_unmapfile()\n");
+
+    if (pview && munmap(pview,pview_size))
+        os_error();
+    pview = NULL;
+    pview_size = 0;
+
+    if (hFile != -1 && close(hFile))
+        os_error();
+    hFile = -1;
+}
+
+/****************************************
+ * Determine a base address that we can use for mapping files to.
+ * It is only a hint, as vmem_mapfile() will map elsewhere if need be.
+ */
+
+void *vmem_baseaddr()
+{
+    if (sizeof(void *) == 4)
+        return (void *) 0x38000000;
+    return (void *) ((size_t)0x38 << 36);
+}
+
+/********************************************
+ * Calculate the amount of memory to reserve, adjusting *psize.
+ * All of the compiler's heap comes out of the reservation, and
+ * address space is reserved without backing store, so be generous.
+ * Stay below 2Gb so offsets into it fit in an int.
+ */
+
+void vmem_reservesize(unsigned *psize)
+{
+    unsigned size = (sizeof(void *) == 4) ? 0x10000000 : 0x40000000;
+    if (*psize < size)
+        *psize = size;
+}
+
+/********************************************
+ * Return amount of physical memory.
+ */
+
+unsigned vmem_physmem()
+{
+    unsigned long long size;
+
+    size = (unsigned long long)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    return (size > 0xFFFFFFFF) ? 0xFFFFFFFF : size;
+}
+
+#endif
+
 /*******************************************
  * Return !=0 if file exists.
  *      0:      file doesn't exist
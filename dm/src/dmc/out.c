@@ -1257,6 +1257,12 @@ STATIC void writefunc2(symbol *sfunc)
             objmod->comdat(sfunc);
             cseg = sfunc->Sseg;
         }
+        else if ((config.flags4 & CFG4optimized) && profile_cold(sfunc))
+        {                               // never called in the profiling run
+            csegsave = cseg;
+            sfunc->Sseg = objmod->coldcodeseg();
+            cseg = sfunc->Sseg;
+        }
         else
             if (config.flags & CFGsegs) // if user set switch for this
             {
@@ -1396,9 +1402,8 @@ STATIC void writefunc2(symbol *sfunc)
      cod3_adjSymOffsets();
 #endif
 
-    if (symbol_iscomdat(sfunc))         // if generated a COMDAT
+    if (csegsave != CSEGSAVE_DEFAULT)   // if generated a COMDAT or cold function
     {
-        assert(csegsave != CSEGSAVE_DEFAULT);
         objmod->setcodeseg(csegsave);       // reset to real code seg
         if (config.objfmt == OBJ_MACH)
             assert(cseg == CODE);
@@ -225,6 +225,7 @@ struct blklst
     int         BLtextmax;      /* size of text buffer                  */
     unsigned char *BLbuf;       // BLfile: file buffer
     unsigned char *BLbufp;      // BLfile: next position in file buffer
+    unsigned char *BLbufend;    // BLfile: the ^Z sentinel ending the file buffer
 #if IMPLIED_PRAGMA_ONCE
     char        *BLinc_once_id; // macro identifier for #include guard
 #endif
@@ -563,7 +564,7 @@ void ph_add_global_symdef(symbol *s, unsigned sctype);
 #define ph_dehydrate(p) ((void)(p))
 extern void *ph_hdrbaseaddress;
 extern void *ph_hdrmaxaddress;
-extern int   ph_hdradjust;
+extern ptrdiff_t ph_hdradjust;
 #elif H_STYLE & H_BIT0
 #define dohydrate       1
 #define isdehydrated(p) ((int)(p) & 1)
@@ -587,7 +588,7 @@ void *ph_dehydrate(void *pp);
 /* pragma.c */
 int pragma_search(const char *id);
 macro_t *macfind(void);
-macro_t *macdefined(const char *id, unsigned hash);
+macro_t *macdefined(const char *id);
 void listident(void);
 char *filename_stringize(char *name);
 unsigned char *macro_predefined(macro_t *m);
@@ -647,6 +648,7 @@ void template_declaration(Classsym *stag, unsigned access_specifier);
 void template_instantiate(void);
 type *template_expand_type(symbol *s);
 Classsym *template_expand(symbol *s, int flag);
+void template_addinstance(symbol *stempl, Classsym *si);
 void template_instantiate_forward(Classsym *stag);
 param_t *template_gargs(symbol *s);
 param_t *template_gargs2(symbol *s);
@@ -735,7 +737,6 @@ extern "C" extern FILE *fdmodule;
 extern "C" extern FILE *fout;
 #endif
 
-extern unsigned idhash;        // hash value of identifier
 extern tym_t pointertype;       // default data pointer type
 extern int level;               // declaration level
                                 // -2: base class list
@@ -40,9 +40,21 @@
 static char __file__[] = __FILE__;      /* for tassert.h                */
 #include        "tassert.h"
 
+#define METRICS 0
+
+#if SCPP
+void symbol_table_metrics(void);
+#endif
+
 //STATIC void symbol_undef(symbol *s);
 STATIC void symbol_freemember(symbol *s);
 STATIC void mptr_hydrate(mptr_t **);
+#if HYDRATE
+STATIC void symbol_fields_hydrate(symbol *s);
+#endif
+#if SCPP && H_STYLE & H_OFFSET
+STATIC void symbol_hydrate_pending(symbol *s);
+#endif
 STATIC void mptr_dehydrate(mptr_t **);
 STATIC void baseclass_hydrate(baseclass_t **);
 STATIC void baseclass_dehydrate(baseclass_t **);
@@ -506,6 +518,69 @@ void symbol_tree_check(symbol *s)
 
 #endif
 
+#if SCPP
+
+/*********************************
+ * Symbol tables are binary trees ordered by identifier, which
+ * degenerate into lists when identifiers are declared in sorted order.
+ * To prevent that, the trees are kept as treaps: each symbol also has a
+ * priority, computed from a hash of its identifier, and no symbol has a
+ * higher priority than its parent. Since the priority does not depend on
+ * declaration order, the expected depth is O(log n) whatever the order.
+ * Lookups are unchanged, findsy() still just walks Sl and Sr.
+ */
+
+#define SYMPATHMAX 64                   // links remembered by insertion, power of 2
+
+STATIC unsigned symbol_priority(symbol *s)
+{
+    if (!s->Spriority)                  // computed once, on first use
+    {
+        unsigned h = 2166136261u;       // FNV-1a
+        for (const char *id = s->Sident; *id; id++)
+            h = (h ^ (unsigned char)*id) * 16777619u;
+        h ^= h >> 16;                   // mix trailing characters into high bits
+        h *= 0x85EBCA6B;
+        h ^= h >> 13;
+        s->Spriority = h | 1;           // never 0
+    }
+    return s->Spriority;
+}
+
+/*********************************
+ * Rotate a newly inserted symbol up the tree until its parent
+ * has a priority at least as high.
+ * Input:
+ *      path    links from the root to the new symbol, indexed by depth
+ *              modulo SYMPATHMAX
+ *      depth   depth of the new symbol
+ */
+
+STATIC void symbol_siftup(symbol **path[SYMPATHMAX], unsigned depth)
+{
+    symbol *s = *path[depth & (SYMPATHMAX - 1)];
+    unsigned priority = symbol_priority(s);
+
+    for (unsigned i = 1; i < SYMPATHMAX && i <= depth; i++)
+    {
+        symbol **pp = path[(depth - i) & (SYMPATHMAX - 1)];    // link to parent
+        symbol *sp = *pp;
+        if (symbol_priority(sp) >= priority)
+            break;
+        if (sp->Sl == s)
+        {   sp->Sl = s->Sr;
+            s->Sr = sp;
+        }
+        else
+        {   sp->Sr = s->Sl;
+            s->Sl = sp;
+        }
+        *pp = s;
+    }
+}
+
+#endif
+
 /********************************
  * Insert symbol in specified symbol table.
  */
@@ -518,6 +593,8 @@ void symbol_addtotree(symbol **parent,symbol *s)
    size_t len;
    const char *p;
    char c;
+   symbol **path[SYMPATHMAX];
+   unsigned depth = 0;
 
    //dbg_printf("symbol_addtotree('%s',%p)\n",s->Sident,*parent);
 #ifdef DEBUG
@@ -529,6 +606,7 @@ void symbol_addtotree(symbol **parent,symbol *s)
    c = *p;
    len = strlen(p);
    p++;
+   path[0] = parent;
    rover = *parent;
    while (rover != NULL)                // while we haven't run out of tree
    {    symbol_debug(rover);
@@ -536,6 +614,9 @@ void symbol_addtotree(symbol **parent,symbol *s)
         {   cmp = memcmp(p,rover->Sident + 1,len); // compare identifier strings
             if (cmp == 0)               // found it if strings match
             {
+#if H_STYLE & H_OFFSET
+                symbol_hydrate_pending(rover);
+#endif
                 if (CPP)
                 {   symbol *s2;
 
@@ -590,9 +671,11 @@ void symbol_addtotree(symbol **parent,symbol *s)
             &(rover->Sl) :              /* then get left child          */
             &(rover->Sr);               /* else get right child         */
         rover = *parent;                /* get child                    */
+        path[++depth & (SYMPATHMAX - 1)] = parent;
    }
    /* not in table, so insert into table        */
    *parent = s;                         /* link new symbol into tree    */
+   symbol_siftup(path, depth);
 L1:
    ;
 }
@@ -627,6 +710,11 @@ symbol * lookupsym(const char *p)
 
 #if SCPP
 
+#if METRICS
+static unsigned long findsy_lookups;    // calls to findsy()
+static unsigned long findsy_probes;     // symbols compared by findsy()
+#endif
+
 symbol * findsy(const char *p,symbol *rover)
 {
 #if TX86 && __DMC__
@@ -697,26 +785,36 @@ L5:             rep     cmpsb
                 test    EBX,EBX
                 jne     L4
 
-L6:     mov     EAX,EBX
+L6:     mov     rover,EBX
     }
 #else
     size_t len;
     signed char cmp;                    /* set to value of strcmp       */
     char c = *p;
 
+#if METRICS
+    findsy_lookups++;
+#endif
     len = strlen(p);
     p++;                                // will pick up 0 on memcmp
     while (rover != NULL)               // while we haven't run out of tree
     {   symbol_debug(rover);
+#if METRICS
+        findsy_probes++;
+#endif
         if ((cmp = c - rover->Sident[0]) == 0)
         {   cmp = memcmp(p,rover->Sident + 1,len); /* compare identifier strings */
             if (cmp == 0)
-                return rover;           /* found it if strings match    */
+                break;                  /* found it if strings match    */
         }
         rover = (cmp < 0) ? rover->Sl : rover->Sr;
     }
-    return rover;                       // failed to find it
 #endif
+#if H_STYLE & H_OFFSET
+    if (rover)
+        symbol_hydrate_pending(rover);
+#endif
+    return rover;                       // NULL if failed to find it
 }
 
 #endif
@@ -754,6 +852,8 @@ void createlocalsymtab()
 void deletesymtab()
 {   symbol *root;
 
+    if (configv.verbose == 2 && !funcsym_p)
+        symbol_table_metrics();
     root = (symbol *)scope_pop();
     if (root)
     {
@@ -1179,15 +1279,40 @@ symbol *symbol_search(const char *id)
 
 /*******************************************
  * Hydrate a symbol tree.
+ * With H_OFFSET, most symbols in a big precompiled header are never
+ * referred to, so symbol_tree_hydrate() just hydrates the tree itself.
+ * A symbol whose Stype is still dehydrated is pending; its contents are
+ * hydrated when findsy() finds it, or when it is reached through some
+ * other dehydrated pointer.
  */
 
+#if SCPP && H_STYLE & H_OFFSET
+unsigned symbol_deferred;               // symbols left pending by symbol_tree_hydrate()
+unsigned symbol_lazyhydrated;           // pending symbols hydrated when looked up
+
+STATIC void symbol_hydrate_pending(symbol *s)
+{
+    if (isdehydrated(s->Stype))
+    {   symbol_lazyhydrated++;
+        symbol_fields_hydrate(s);
+    }
+}
+#endif
+
 #if HYDRATE
 void symbol_tree_hydrate(symbol **ps)
 {   symbol *s;
 
     while (isdehydrated(*ps))           /* if symbol is dehydrated      */
     {
+#if SCPP && H_STYLE & H_OFFSET
+        // Only hydrate the links, leave the rest for symbol_hydrate_pending()
+        s = (symbol *) ph_hydrate(ps);
+        if (isdehydrated(s->Stype))
+            symbol_deferred++;
+#else
         s = symbol_hydrate(ps);
+#endif
         symbol_debug(s);
         if (s->Scover)
             symbol_hydrate(&s->Scover);
@@ -1231,187 +1356,196 @@ symbol *symbol_hydrate(symbol **ps)
 
     s = *ps;
     if (isdehydrated(s))                /* if symbol is dehydrated      */
-    {   type *t;
-        struct_t *st;
-
+    {
         s = (symbol *) ph_hydrate(ps);
+        symbol_fields_hydrate(s);
+    }
+    return s;
+}
+
+/*******************************************
+ * Hydrate the contents of a symbol whose own pointer is already hydrated.
+ */
+
+STATIC void symbol_fields_hydrate(symbol *s)
+{   type *t;
+    struct_t *st;
+
 #ifdef DEBUG
-        debugy && dbg_printf("symbol_hydrate('%s')\n",s->Sident);
+    debugy && dbg_printf("symbol_hydrate('%s')\n",s->Sident);
 #endif
-        symbol_debug(s);
-        if (!isdehydrated(s->Stype))    // if this symbol is already dehydrated
-            return s;                   // no need to do it again
-        if (pstate.SThflag != FLAG_INPLACE && s->Sfl != FLreg)
-            s->Sxtrnnum = 0;            // not written to .OBJ file yet
-        type_hydrate(&s->Stype);
-        //dbg_printf("symbol_hydrate(%p, '%s', t = %p)\n",s,s->Sident,s->Stype);
-        t = s->Stype;
-        if (t)
-            type_debug(t);
+    symbol_debug(s);
+    if (!isdehydrated(s->Stype))    // if this symbol is already hydrated
+        return;                     // no need to do it again
+    if (pstate.SThflag != FLAG_INPLACE && s->Sfl != FLreg)
+        s->Sxtrnnum = 0;            // not written to .OBJ file yet
+    type_hydrate(&s->Stype);
+    //dbg_printf("symbol_hydrate(%p, '%s', t = %p)\n",s,s->Sident,s->Stype);
+    t = s->Stype;
+    if (t)
+        type_debug(t);
 
-        if (t && tyfunc(t->Tty) && ph_hydrate(&s->Sfunc))
-        {
-            func_t *f = s->Sfunc;
-            SYMIDX si;
+    if (t && tyfunc(t->Tty) && ph_hydrate(&s->Sfunc))
+    {
+        func_t *f = s->Sfunc;
+        SYMIDX si;
 
-            debug(assert(f));
+        debug(assert(f));
 
-            list_hydrate(&f->Fsymtree,(list_free_fp)symbol_tree_hydrate);
-            blocklist_hydrate(&f->Fstartblock);
+        list_hydrate(&f->Fsymtree,(list_free_fp)symbol_tree_hydrate);
+        blocklist_hydrate(&f->Fstartblock);
 
-            ph_hydrate(&f->Flocsym.tab);
-            for (si = 0; si < f->Flocsym.top; si++)
-                symbol_hydrate(&f->Flocsym.tab[si]);
+        ph_hydrate(&f->Flocsym.tab);
+        for (si = 0; si < f->Flocsym.top; si++)
+            symbol_hydrate(&f->Flocsym.tab[si]);
 
-            srcpos_hydrate(&f->Fstartline);
-            srcpos_hydrate(&f->Fendline);
+        srcpos_hydrate(&f->Fstartline);
+        srcpos_hydrate(&f->Fendline);
 
-            symbol_hydrate(&f->F__func__);
+        symbol_hydrate(&f->F__func__);
 
-            if (CPP)
-            {
-                symbol_hydrate(&f->Fparsescope);
-                Classsym_hydrate(&f->Fclass);
-                symbol_hydrate(&f->Foversym);
-                symbol_hydrate(&f->Fexplicitspec);
-                symbol_hydrate(&f->Fsurrogatesym);
-
-                list_hydrate(&f->Fclassfriends,(list_free_fp)symbol_hydrate);
-                el_hydrate(&f->Fbaseinit);
-                token_hydrate(&f->Fbody);
-                symbol_hydrate(&f->Falias);
-                list_hydrate(&f->Fthunks,(list_free_fp)symbol_hydrate);
-                if (f->Fflags & Finstance)
-                    symbol_hydrate(&f->Ftempl);
-                else
-                    thunk_hydrate(&f->Fthunk);
-                param_hydrate(&f->Farglist);
-                param_hydrate(&f->Fptal);
-                list_hydrate(&f->Ffwdrefinstances,(list_free_fp)symbol_hydrate);
-                list_hydrate(&f->Fexcspec,(list_free_fp)type_hydrate);
-            }
-        }
         if (CPP)
-            symbol_hydrate(&s->Sscope);
-        switch (s->Sclass)
         {
-            case SCstruct:
-              if (CPP)
-              {
-                st = (struct_t *) ph_hydrate(&s->Sstruct);
-                assert(st);
-                symbol_tree_hydrate(&st->Sroot);
-                ph_hydrate(&st->Spvirtder);
-                list_hydrate(&st->Sfldlst,(list_free_fp)symbol_hydrate);
-                list_hydrate(&st->Svirtual,(list_free_fp)mptr_hydrate);
-                list_hydrate(&st->Sopoverload,(list_free_fp)symbol_hydrate);
-                list_hydrate(&st->Scastoverload,(list_free_fp)symbol_hydrate);
-                list_hydrate(&st->Sclassfriends,(list_free_fp)symbol_hydrate);
-                list_hydrate(&st->Sfriendclass,(list_free_fp)symbol_hydrate);
-                list_hydrate(&st->Sfriendfuncs,(list_free_fp)symbol_hydrate);
-                assert(!st->Sinlinefuncs);
-
-                baseclass_hydrate(&st->Sbase);
-                baseclass_hydrate(&st->Svirtbase);
-                baseclass_hydrate(&st->Smptrbase);
-                baseclass_hydrate(&st->Sprimary);
-                baseclass_hydrate(&st->Svbptrbase);
-
-                ph_hydrate(&st->Svecctor);
-                ph_hydrate(&st->Sctor);
-                ph_hydrate(&st->Sdtor);
-                ph_hydrate(&st->Sprimdtor);
-                ph_hydrate(&st->Spriminv);
-                ph_hydrate(&st->Sscaldeldtor);
-                ph_hydrate(&st->Sinvariant);
-                ph_hydrate(&st->Svptr);
-                ph_hydrate(&st->Svtbl);
-                ph_hydrate(&st->Sopeq);
-                ph_hydrate(&st->Sopeq2);
-                ph_hydrate(&st->Scpct);
-                ph_hydrate(&st->Sveccpct);
-                ph_hydrate(&st->Salias);
-                ph_hydrate(&st->Stempsym);
-                param_hydrate(&st->Sarglist);
-                param_hydrate(&st->Spr_arglist);
-                ph_hydrate(&st->Svbptr);
-                ph_hydrate(&st->Svbptr_parent);
-                ph_hydrate(&st->Svbtbl);
-              }
-              else
-              {
-                ph_hydrate(&s->Sstruct);
-                symbol_tree_hydrate(&s->Sstruct->Sroot);
-                list_hydrate(&s->Sstruct->Sfldlst,(list_free_fp)symbol_hydrate);
-              }
-                break;
-
-            case SCenum:
-                assert(s->Senum);
-                ph_hydrate(&s->Senum);
-                if (CPP)
-                {   ph_hydrate(&s->Senum->SEalias);
-                    list_hydrate(&s->Senumlist,(list_free_fp)symbol_hydrate);
-                }
-                break;
-
-            case SCtemplate:
-            {   template_t *tm;
+            symbol_hydrate(&f->Fparsescope);
+            Classsym_hydrate(&f->Fclass);
+            symbol_hydrate(&f->Foversym);
+            symbol_hydrate(&f->Fexplicitspec);
+            symbol_hydrate(&f->Fsurrogatesym);
+
+            list_hydrate(&f->Fclassfriends,(list_free_fp)symbol_hydrate);
+            el_hydrate(&f->Fbaseinit);
+            token_hydrate(&f->Fbody);
+            symbol_hydrate(&f->Falias);
+            list_hydrate(&f->Fthunks,(list_free_fp)symbol_hydrate);
+            if (f->Fflags & Finstance)
+                symbol_hydrate(&f->Ftempl);
+            else
+                thunk_hydrate(&f->Fthunk);
+            param_hydrate(&f->Farglist);
+            param_hydrate(&f->Fptal);
+            list_hydrate(&f->Ffwdrefinstances,(list_free_fp)symbol_hydrate);
+            list_hydrate(&f->Fexcspec,(list_free_fp)type_hydrate);
+        }
+    }
+    if (CPP)
+        symbol_hydrate(&s->Sscope);
+    switch (s->Sclass)
+    {
+        case SCstruct:
+          if (CPP)
+          {
+            st = (struct_t *) ph_hydrate(&s->Sstruct);
+            assert(st);
+            symbol_tree_hydrate(&st->Sroot);
+            ph_hydrate(&st->Spvirtder);
+            list_hydrate(&st->Sfldlst,(list_free_fp)symbol_hydrate);
+            list_hydrate(&st->Svirtual,(list_free_fp)mptr_hydrate);
+            list_hydrate(&st->Sopoverload,(list_free_fp)symbol_hydrate);
+            list_hydrate(&st->Scastoverload,(list_free_fp)symbol_hydrate);
+            list_hydrate(&st->Sclassfriends,(list_free_fp)symbol_hydrate);
+            list_hydrate(&st->Sfriendclass,(list_free_fp)symbol_hydrate);
+            list_hydrate(&st->Sfriendfuncs,(list_free_fp)symbol_hydrate);
+            assert(!st->Sinlinefuncs);
+
+            baseclass_hydrate(&st->Sbase);
+            baseclass_hydrate(&st->Svirtbase);
+            baseclass_hydrate(&st->Smptrbase);
+            baseclass_hydrate(&st->Sprimary);
+            baseclass_hydrate(&st->Svbptrbase);
+
+            ph_hydrate(&st->Svecctor);
+            ph_hydrate(&st->Sctor);
+            ph_hydrate(&st->Sdtor);
+            ph_hydrate(&st->Sprimdtor);
+            ph_hydrate(&st->Spriminv);
+            ph_hydrate(&st->Sscaldeldtor);
+            ph_hydrate(&st->Sinvariant);
+            ph_hydrate(&st->Svptr);
+            ph_hydrate(&st->Svtbl);
+            ph_hydrate(&st->Sopeq);
+            ph_hydrate(&st->Sopeq2);
+            ph_hydrate(&st->Scpct);
+            ph_hydrate(&st->Sveccpct);
+            ph_hydrate(&st->Salias);
+            ph_hydrate(&st->Stempsym);
+            param_hydrate(&st->Sarglist);
+            param_hydrate(&st->Spr_arglist);
+            ph_hydrate(&st->Svbptr);
+            ph_hydrate(&st->Svbptr_parent);
+            ph_hydrate(&st->Svbtbl);
+          }
+          else
+          {
+            ph_hydrate(&s->Sstruct);
+            symbol_tree_hydrate(&s->Sstruct->Sroot);
+            list_hydrate(&s->Sstruct->Sfldlst,(list_free_fp)symbol_hydrate);
+          }
+            break;
 
-                tm = (template_t *) ph_hydrate(&s->Stemplate);
-                list_hydrate(&tm->TMinstances,(list_free_fp)symbol_hydrate);
-                list_hydrate(&tm->TMfriends,(list_free_fp)symbol_hydrate);
-                param_hydrate(&tm->TMptpl);
-                param_hydrate(&tm->TMptal);
-                token_hydrate(&tm->TMbody);
-                list_hydrate(&tm->TMmemberfuncs,(list_free_fp)tmf_hydrate);
-                list_hydrate(&tm->TMexplicit,(list_free_fp)tme_hydrate);
-                list_hydrate(&tm->TMnestedexplicit,(list_free_fp)tmne_hydrate);
-                list_hydrate(&tm->TMnestedfriends,(list_free_fp)tmnf_hydrate);
-                ph_hydrate(&tm->TMnext);
-                symbol_hydrate(&tm->TMpartial);
-                symbol_hydrate(&tm->TMprimary);
-                break;
+        case SCenum:
+            assert(s->Senum);
+            ph_hydrate(&s->Senum);
+            if (CPP)
+            {   ph_hydrate(&s->Senum->SEalias);
+                list_hydrate(&s->Senumlist,(list_free_fp)symbol_hydrate);
             }
+            break;
 
-            case SCnamespace:
-                symbol_tree_hydrate(&s->Snameroot);
-                list_hydrate(&s->Susing,(list_free_fp)symbol_hydrate);
-                break;
+        case SCtemplate:
+        {   template_t *tm;
+
+            tm = (template_t *) ph_hydrate(&s->Stemplate);
+            list_hydrate(&tm->TMinstances,(list_free_fp)symbol_hydrate);
+            list_hydrate(&tm->TMfriends,(list_free_fp)symbol_hydrate);
+            param_hydrate(&tm->TMptpl);
+            param_hydrate(&tm->TMptal);
+            token_hydrate(&tm->TMbody);
+            list_hydrate(&tm->TMmemberfuncs,(list_free_fp)tmf_hydrate);
+            list_hydrate(&tm->TMexplicit,(list_free_fp)tme_hydrate);
+            list_hydrate(&tm->TMnestedexplicit,(list_free_fp)tmne_hydrate);
+            list_hydrate(&tm->TMnestedfriends,(list_free_fp)tmnf_hydrate);
+            ph_hydrate(&tm->TMnext);
+            symbol_hydrate(&tm->TMpartial);
+            symbol_hydrate(&tm->TMprimary);
+            break;
+        }
 
-            case SCmemalias:
-            case SCfuncalias:
-            case SCadl:
-                list_hydrate(&s->Spath,(list_free_fp)symbol_hydrate);
-            case SCalias:
-                ph_hydrate(&s->Smemalias);
-                break;
+        case SCnamespace:
+            symbol_tree_hydrate(&s->Snameroot);
+            list_hydrate(&s->Susing,(list_free_fp)symbol_hydrate);
+            break;
 
-            default:
-                if (s->Sflags & (SFLvalue | SFLdtorexp))
-                    el_hydrate(&s->Svalue);
-                break;
-        }
-        {   dt_t **pdt,*dt;
+        case SCmemalias:
+        case SCfuncalias:
+        case SCadl:
+            list_hydrate(&s->Spath,(list_free_fp)symbol_hydrate);
+        case SCalias:
+            ph_hydrate(&s->Smemalias);
+            break;
 
-            for (pdt = &s->Sdt; isdehydrated(*pdt); pdt = &dt->DTnext)
-            {
-                dt = (dt_t *) ph_hydrate(pdt);
-                switch (dt->dt)
-                {   case DT_abytes:
-                    case DT_nbytes:
-                        ph_hydrate(&dt->DTpbytes);
-                        break;
-                    case DT_xoff:
-                        symbol_hydrate(&dt->DTsym);
-                        break;
-                }
+        default:
+            if (s->Sflags & (SFLvalue | SFLdtorexp))
+                el_hydrate(&s->Svalue);
+            break;
+    }
+    {   dt_t **pdt,*dt;
+
+        for (pdt = &s->Sdt; isdehydrated(*pdt); pdt = &dt->DTnext)
+        {
+            dt = (dt_t *) ph_hydrate(pdt);
+            switch (dt->dt)
+            {   case DT_abytes:
+                case DT_nbytes:
+                    ph_hydrate(&dt->DTpbytes);
+                    break;
+                case DT_xoff:
+                    symbol_hydrate(&dt->DTsym);
+                    break;
             }
         }
-        if (s->Scover)
-            symbol_hydrate(&s->Scover);
     }
-    return s;
+    if (s->Scover)
+        symbol_hydrate(&s->Scover);
 }
 #endif
 
@@ -1700,6 +1834,8 @@ void symbol_symdefs_hydrate(symbol **ps,symbol **parent,int flag)
             symbol *rover;
             char c;
             size_t len;
+            symbol **path[SYMPATHMAX];
+            unsigned depth = 0;
 
             p = s->Sident;
             c = *p;
@@ -1713,6 +1849,7 @@ void symbol_symdefs_hydrate(symbol **ps,symbol **parent,int flag)
             len = strlen(p);
             p++;
             ps = parent;
+            path[0] = ps;
             while ((rover = *ps) != NULL)
             {   signed char cmp;
 
@@ -1720,6 +1857,9 @@ void symbol_symdefs_hydrate(symbol **ps,symbol **parent,int flag)
                 {   cmp = memcmp(p,rover->Sident + 1,len); // compare identifier strings
                     if (cmp == 0)
                     {
+#if H_STYLE & H_OFFSET
+                        symbol_hydrate_pending(rover);
+#endif
                         if (CPP && tyfunc(s->Stype->Tty) && tyfunc(rover->Stype->Tty))
                         {   symbol **ps;
                             symbol *sn;
@@ -1773,8 +1913,10 @@ void symbol_symdefs_hydrate(symbol **ps,symbol **parent,int flag)
                 ps = (cmp < 0) ?        /* if we go down left side      */
                     &rover->Sl :
                     &rover->Sr;
+                path[++depth & (SYMPATHMAX - 1)] = ps;
             }
             *ps = s;
+            symbol_siftup(path, depth);
             if (s->Sclass == SCcomdef)
             {   s->Sclass = SCglobal;
                 outcommon(s,type_size(s->Stype));
@@ -2154,12 +2296,6 @@ STATIC symbol * create_tree(int i, int lo, int hi)
     return s;
 }
 
-#define METRICS 0
-
-#if METRICS
-void symbol_table_metrics(void);
-#endif
-
 void symboltable_balance(symbol **ps)
 {
     Balance balancesave;
@@ -2195,6 +2331,46 @@ Lret:
     balance = balancesave;
 }
 
+STATIC void tree_metrics(symbol *s, unsigned depth, unsigned *pnsyms, unsigned long *pprobes, unsigned *pmaxprobes)
+{
+    while (s)
+    {
+        depth++;                        // probes needed to find s
+        ++*pnsyms;
+        *pprobes += depth;
+        if (depth > *pmaxprobes)
+            *pmaxprobes = depth;
+        tree_metrics(s->Sl, depth, pnsyms, pprobes, pmaxprobes);
+        s = s->Sr;
+    }
+}
+
+/*****************************************
+ * Print the average and worst probe length of each symbol table scope,
+ * and with METRICS the average probe length actually seen by findsy().
+ * Printed under -v2 when the global symbol table is deleted.
+ */
+
+void symbol_table_metrics()
+{
+    for (Scope *sc = scope_end; sc; sc = sc->next)
+    {
+        if (sc->fpsearch != (scope_fp)findsy || !sc->root)
+            continue;
+        unsigned nsyms = 0;
+        unsigned long probes = 0;
+        unsigned maxprobes = 0;
+        tree_metrics((symbol *)sc->root, 0, &nsyms, &probes, &maxprobes);
+        dbg_printf("scope x%x: %u symbols, average probe length %.2f, max %u\n",
+            sc->sctype, nsyms, (double)probes / nsyms, maxprobes);
+    }
+#if METRICS
+    if (findsy_lookups)
+        dbg_printf("findsy: %lu lookups, average probe length %.2f\n",
+            findsy_lookups, (double)findsy_probes / findsy_lookups);
+#endif
+}
+
 #endif
 
 /*****************************************
@@ -2220,6 +2396,9 @@ STATIC void membersearchx(struct Paramblock *p,symbol *s)
 
     while (s)
     {   symbol_debug(s);
+#if H_STYLE & H_OFFSET
+        symbol_hydrate_pending(s);
+#endif
 
         switch (s->Sclass)
         {   case SCstruct:
@@ -2273,6 +2452,9 @@ STATIC void symbol_gendebuginfox(symbol *s)
             symbol_gendebuginfox(s->Sl);
         if (s->Scover)
             symbol_gendebuginfox(s->Scover);
+#if H_STYLE & H_OFFSET
+        symbol_hydrate_pending(s);
+#endif
         switch (s->Sclass)
         {
             case SCenum:
@@ -40,6 +40,7 @@ void vec_orass (vec_t v1 , vec_t v2);
 void vec_or (vec_t v1 , vec_t v2 , vec_t v3);
 void vec_subass (vec_t v1 , vec_t v2);
 void vec_sub (vec_t v1 , vec_t v2 , vec_t v3);
+int vec_subor (vec_t v1 , vec_t v2 , vec_t v3 , vec_t v4);
 void vec_clear (vec_t v);
 void vec_set (vec_t v);
 void vec_copy (vec_t to , vec_t from);
@@ -239,6 +239,7 @@ struct token_t
 #define TKFfree         1       // free the token after it's scanned
 #define TKFinherited    2       // keyword INHERITED prior to token
 #define TKFpasstr       4       // pascal string
+#define TKFinterned     8       // TKid is shared, see token_intern()
     unsigned char TKty;         // TYxxxx for TKstring and TKnum
     union _TKutok
     {
@@ -343,7 +344,6 @@ char *combinestrings(targ_size_t *plen);
 char *combinestrings(targ_size_t *plen, tym_t *pty);
 void inident(void);
 void inidentX(char *p);
-unsigned comphash(const char *p);
 int insertSpace(unsigned char xclast, unsigned char xcnext);
 void panic(enum_TK ptok);
 void chktok(enum_TK toknum , unsigned errnum);
@@ -361,7 +361,7 @@ void token_term(void);
 void pragma_process();
 int pragma_search(const char *id);
 macro_t * macfind(void);
-macro_t *macdefined(const char *id, unsigned hash);
+macro_t *macdefined(const char *id);
 void listident(void);
 void pragma_term(void);
 macro_t *defmac(const char *name , const char *text);
@@ -133,7 +133,6 @@ list_t headers;                 /* pre-include files                    */
 
 /* Data from lexical analyzer: */
 
-unsigned idhash = 0;    // hash value of identifier
 int xc = ' ';           // character last read
 
 /* Data for pragma processor: